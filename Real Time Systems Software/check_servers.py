@@ -0,0 +1,96 @@
+"""
+Regresyon kontrolü: input dosyasında tek bir S satırıyla tanımlanan server, komut satırından
+verilen aynı server ile birebir aynı schedule'ı üretmeli (aynı sonuç, aynı aralıklar). Rastgele
+task set'lerde her algoritma ve ona uyan her server tipi denenir.
+
+  g++ -O2 -shared -fPIC -pthread -DRTS_LIBRARY -o librts.so rts.cpp
+  python check_servers.py                 (varsayılan 200 set)
+  python check_servers.py --sets 1000 --seed 7
+
+Fark bulunursa ilk farklar yazdırılır ve çıkış kodu 1 olur.
+"""
+import argparse
+import random
+import sys
+
+import rts
+
+FIXED = ["rm", "dm", "opa"]
+DYNAMIC = ["edf", "llf", "ellf"]
+# (komut satırı adı, S satırındaki adı, budget/period alır mı); ss sadece sabit öncelikle,
+# tbs/cbs sadece deadline'a göre çalışır
+SERVERS = [("background", "background", False), ("polling", "polling", True),
+           ("deferrable", "deferrable", True), ("sporadic", "sporadic", True),
+           ("tbs", "tbs", True), ("cbs", "cbs", True)]
+OPTIONS = ["", "--on-miss=continue", "--switch-cost=1", "--steady-state"]
+
+
+def random_set(rng):
+    """P/D satırları ve A satırlarından oluşan küçük bir task set metni."""
+    lines = []
+    for _ in range(rng.randint(1, 4)):
+        p = rng.choice([4, 5, 6, 8, 10, 12, 15, 20])
+        e = rng.randint(1, max(1, p // 3))
+        k = rng.random()
+        if k < 0.2:
+            lines.append(f"D {e} {p} {rng.randint(e, p)}")
+        elif k < 0.4:
+            lines.append(f"P {rng.randint(0, 5)} {e} {p}")
+        else:
+            lines.append(f"P {e} {p}")
+    for _ in range(rng.randint(1, 5)):
+        lines.append(f"A {rng.randint(0, 40)} {rng.randint(1, 5)}")
+    return "\n".join(lines) + "\n"
+
+
+def fits(algorithm, server):
+    if server == "sporadic":
+        return algorithm in FIXED
+    if server in ("tbs", "cbs"):
+        return algorithm in DYNAMIC
+    return True
+
+
+def main():
+    parser = argparse.ArgumentParser(description="Tanımlı tek server = komut satırı server'ı kontrolü")
+    parser.add_argument("--sets", type=int, default=200)
+    parser.add_argument("--seed", type=int, default=1)
+    parser.add_argument("--lib", default=None, help="librts.so / rts.dll yolu")
+    args = parser.parse_args()
+
+    lib = rts.Library(args.lib)
+    rng = random.Random(args.seed)
+    runs = differences = 0
+    for n in range(args.sets):
+        text = random_set(rng)
+        budget = rng.randint(1, 3)
+        period = rng.randint(budget + 2, 10)
+        plain = lib.parse(text)
+        for server, declared_type, budgeted in SERVERS:
+            line = f"S ServerTask {declared_type}" + (f" {budget} {period}" if budgeted else "")
+            declared = lib.parse(line + "\n" + text)
+            for algorithm in FIXED + DYNAMIC:
+                if not fits(algorithm, server):
+                    continue
+                for options in OPTIONS:
+                    runs += 1
+                    b, p = (budget, period) if budgeted else (0, 0)
+                    try:
+                        expected = plain.run(0, algorithm, server, b, p, options)
+                    except rts.RtsError as e:
+                        expected = str(e)
+                    try:
+                        got = declared.run(0, algorithm, None, 0, 0, options)
+                    except rts.RtsError as e:
+                        got = str(e)
+                    if got != expected:
+                        differences += 1
+                        if differences <= 5:
+                            print(f"set {n}, {algorithm} {server} {options or '(no options)'}:")
+                            print(line + "\n" + text)
+    print(f"{runs} runs, {differences} differ")
+    return 1 if differences else 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
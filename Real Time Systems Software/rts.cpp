@@ -2,688 +2,4338 @@
 #include <vector>
 #include <algorithm>
 #include <climits>
+#include <cmath>
 #include <fstream>
 #include <sstream>
 #include <string>
+#include <chrono>
+#include <memory>
+#include <iomanip>
+#include <thread>
+#include <atomic>
+#include <filesystem>
+#include <deque>
+#include <unordered_map>
+#include <cstring>
+#include <cstdio>
+#include <cerrno>
+#ifdef _WIN32
+#define NOMINMAX
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+#include "rts.h"
 
 using namespace std;
 struct Task;
-int gcd(int,int);
-int lcm(int,int);
-int calculate_hyperperiod(const vector<Task>&);
+long long gcd(long long,long long);
+long long lcm(long long,long long);
+long long calculate_hyperperiod(const vector<Task>&);
 bool checkFeasibility(vector<Task>&);
-int findFirstSimultaneousRelease(const std::vector<Task>&);
-void sortByExplicitPriority(vector<Task>&);
-void sortByEarliestDeadline(vector<Task>&);
-void sortByLeastLaxity(vector<Task>&);
-void sortTasksByReleaseTime(vector<Task>&);
-void readInputFile(const string&,vector<Task>&,vector<Task>&);
+long long findFirstSimultaneousRelease(const std::vector<Task>&,string* warning=nullptr);
+struct ArrivalSource;
+struct TaskLine;
+class MappedFile;
+struct DeclaredServer;
+unique_ptr<ArrivalSource> readInputFile(const string&,vector<Task>&,vector<Task>&,vector<DeclaredServer>&);
+bool parseTaskLine(const TaskLine&,vector<Task>&,vector<Task>&,vector<DeclaredServer>&,int&,int&,ostream&);
+void scanInput(const MappedFile&,vector<Task>&,vector<DeclaredServer>&,size_t&,bool&,ostream&);
 int getAlgorithmCode(string);
 string getServerType(string);
+vector<int> optimalPriorityLevels(const vector<Task>&,const vector<long long>&,bool* found=nullptr);
+long long simulationEnd(const vector<Task>&,string* warning=nullptr);
 
+// times are 64-bit; products of two times (bandwidth checks) are formed in WideTime
+#ifdef __SIZEOF_INT128__
+typedef __int128 WideTime;
+#else
+typedef long double WideTime;
+#endif
+
+// ceil(a*b/c) for a,b>=0, c>0 without overflowing the product, LLONG_MAX when the result does not fit
+long long mulCeilDiv(long long a,long long b,long long c){
+    WideTime q=((WideTime)a*b+c-1)/c;
+    return q>(WideTime)LLONG_MAX ? LLONG_MAX : (long long)q;
+}
+
+// a task as read from the input; simulators copy the numbers into a TaskTable
 struct Task{
     string id;
-    int release_time;
-    int exec_time;
-    int period;
-    int deadline_relative;
-    int absolute_deadline;
-    float priority=0.0;
-    bool isActive=false;
-    int remaining_exec = 0;
+    long long release_time;
+    long long exec_time;
+    long long period;
+    long long deadline_relative;
+    int priority=0;     // fixed priority level, higher runs first
+    string tag;         // aperiodic: its class, the declared server serving it ("" for the first one)
     Task() = default;
-    Task(string id_, int r, int e, int p, int d_rel)
+    Task(string id_, long long r, long long e, long long p, long long d_rel)
         : id(id_), release_time(r), exec_time(e),
           period(p), deadline_relative(d_rel)
     {
-        absolute_deadline = release_time + deadline_relative;
-        remaining_exec    = exec_time;
     }
-    Task(string id,int r,int e):id(id),release_time(r),exec_time(e){}
+    Task(string id,long long r,long long e):id(id),release_time(r),exec_time(e){}
 
 };
-void rateMonotonic(vector<Task> &tasks){
-    if(!checkFeasibility(tasks)){
-        cout<<"This task set is not schedulable";
-        return;
+struct Server{
+    string ID;
+    long long period;
+    long long budget;
+    Server(string id,long long p,long long b):ID(id),period(p),budget(b){}
+};
+
+// an "S name type budget period" line: a server of its own for the A lines tagged name, next to
+// the others the file declares (background takes no budget or period)
+struct DeclaredServer{
+    string name;
+    string type;        // as getServerType names it
+    long long budget=0;
+    long long period=0;
+};
+
+// servers running with a budget and a period, as opposed to background service
+bool budgetedServer(const string& type){
+    return type=="POLLER" || type=="DS" || type=="SS" || type=="TBS" || type=="CBS";
+}
+
+// RM, DM and OPA (Audsley's optimal priority assignment) as opposed to EDF and LLF
+bool fixedPriority(int choose){
+    return choose==1 || choose==2 || choose==5;
+}
+
+// the sporadic server needs static priorities, the bandwidth servers deadlines; nullptr if they match
+const char* serverMismatch(int choose,const string& type){
+    if(type=="SS" && !fixedPriority(choose))return "Sporadic server needs RM, DM or OPA.";
+    if((type=="TBS" || type=="CBS") && choose!=3 && choose!=4 && choose!=6)
+        return "Bandwidth servers (TBS, CBS) need EDF, LLF or ELLF.";
+    return nullptr;
+}
+
+// ---------------- simulation ----------------
+// Time is not stepped one unit at a time: the simulator only stops at instants where the
+// decision can change (releases, completions, deadlines, server replenishments, aperiodic
+// arrivals, LLF crossings), so its cost grows with the number of events instead of the
+// length of the hyperperiod. The schedule is the same as stepping every unit.
+
+enum SegmentKind{SEG_IDLE,SEG_TASK,SEG_SERVER,SEG_APERIODIC};
+
+struct Segment{
+    long long start;
+    long long end;            // exclusive
+    SegmentKind kind;
+    int job=-1;               // task number (SEG_TASK) or aperiodic id, -1 while idle
+    int server=-1;            // task number of the serving server (SEG_SERVER only)
+    long long budget=0;       // server budget at start
+    bool backlogEmpty=false;  // no aperiodic task left at all (background idle message)
+    bool overhead=false;      // context switch or cache reload before the job, no progress made
+};
+
+// the input file's ids for the integer ids of segments, looked up only when output is written
+struct JobNames{
+    vector<string> tasks;                  // by task number: periodic tasks, then the server
+    int periodic=0;                        // periodic tasks among them
+    const ArrivalSource* arrivals=nullptr; // names of the aperiodic ids
+    string job(const Segment& s) const;    // empty while idle
+    const string& server(const Segment& s) const { return tasks[s.server]; }
+    size_t arrivalCount() const;
+    string arrival(int id) const;
+};
+
+struct TraceSink{
+    virtual void begin(const JobNames&){}  // called before the first segment of a run
+    virtual void segment(const Segment& s)=0;
+    virtual void finish(){}   // called once the simulation has stopped
+    virtual void warning(const string& text){ cerr<<text<<endl; }
+    virtual ~TraceSink(){}
+};
+
+// prints one line per time unit, the format of the original loops
+struct LegacyTrace:TraceSink{
+    string serverType;
+    ostream& cout;
+    JobNames names;
+    LegacyTrace(string st,ostream& os=std::cout):serverType(st),cout(os){}
+    void begin(const JobNames& n) override{ names=n; }
+    void segment(const Segment& s) override{
+        string job=names.job(s);
+        for(long long time=s.start; time<s.end; time++){
+            if(s.overhead){
+                cout<<"At time: "<<time<<" Context switch to "<<job<<"\n";
+            }else if(s.kind==SEG_TASK){
+                cout<<"At time: "<< time<<" Task" << job<<" is running\n";
+            }else if(s.kind==SEG_SERVER){
+                cout << "At time: " << time << " Server " << names.server(s)
+                << " serving " << job
+                << " (budget: " << s.budget-(time-s.start) << ")\n";
+            }else if(s.kind==SEG_APERIODIC){
+                cout<<"System can run aperiodic task at time:"<< time <<".\n";
+                cout<<"Aperiodic Task: "<<job<<" is running.\n";
+            }else if(serverType=="BG"){
+                cout<<"System can run aperiodic task at time:"<< time <<".\n";
+                if(s.backlogEmpty)cout<<"But there is no aperiodic Task. It is IDLE time\n";
+                else cout<<"But no aperiodic task released yet. It is IDLE time\n";
+            }else if(budgetedServer(serverType)){
+                cout<<"System is Idle at "<< time <<".\n";
+            }else{
+                cout<<time<<" is IDLE\n";
+            }
+        }
+    }
+};
+
+struct NullTrace:TraceSink{
+    void segment(const Segment&) override{}
+};
+
+// no output at all, warnings included; safe to use from several threads at once
+struct SilentTrace:NullTrace{
+    void warning(const string&) override{}
+};
+
+// run length intervals: consecutive segments of the same job are merged, so only
+// the instants where the running job changes produce output
+struct IntervalTrace:TraceSink{
+    Segment open;
+    bool pending=false;
+    JobNames names;
+    void begin(const JobNames& n) override{ names=n; }
+    void segment(const Segment& s) override{
+        if(pending && open.end==s.start && open.kind==s.kind && open.job==s.job
+           && open.overhead==s.overhead){
+            open.end=s.end;
+            return;
+        }
+        if(pending)emit(open);
+        open=s;
+        pending=true;
     }
-     for (auto &t : tasks) {
-        t.priority       = 1.0f / t.period;
-        t.absolute_deadline = t.release_time + t.deadline_relative;
-        t.remaining_exec = t.exec_time;
-        t.isActive       = false;
+    void finish() override{
+        if(pending)emit(open);
+        pending=false;
     }
-    
-    int hyperperiod=calculate_hyperperiod(tasks);
-    int firstSimoultaneous=findFirstSimultaneousRelease(tasks);
-    vector<Task> currentTasks=tasks;
-    for(int time=0; time<hyperperiod+firstSimoultaneous+1; time++){
-        for(auto &ct:currentTasks){
-            if(ct.absolute_deadline<=time){
-                cout<<"Deadline missed for "<< ct.id<<" at " <<time <<". Algorithm is failed.\n";
-                return;
-            }
+    virtual void emit(const Segment& s)=0;
+};
+
+const char* segmentKindName(SegmentKind k){
+    switch(k){
+        case SEG_TASK: return "task";
+        case SEG_SERVER: return "server";
+        case SEG_APERIODIC: return "aperiodic";
+        default: return "idle";
+    }
+}
+
+// start,end,job,kind per line, end exclusive and job empty while idle
+struct CsvTrace:IntervalTrace{
+    ostream& out;
+    CsvTrace(ostream& os):out(os){ out<<"start,end,job,kind\n"; }
+    void emit(const Segment& s) override{
+        out<<s.start<<','<<s.end<<','<<names.job(s)<<','<<(s.overhead?"switch":segmentKindName(s.kind))<<'\n';
+    }
+};
+
+// little endian: "RTSI", uint32 version (2), uint32 name count, names as uint16 length + bytes,
+// then 21 byte records int64 start, int64 end (exclusive), int32 name index (-1 idle), uint8 kind
+// (the periodic tasks, then the aperiodics, so a name index is the segment's job number;
+// kind is the SegmentKind, 4 for the context switch before a job). Version 1 had int32 times, 13 byte records.
+struct BinaryTrace:IntervalTrace{
+    ostream& out;
+    BinaryTrace(ostream& os):out(os){}
+    void begin(const JobNames& n) override{
+        IntervalTrace::begin(n);
+        size_t arrivals=n.arrivalCount();
+        out.write("RTSI",4);
+        put(2,4);
+        put(n.periodic+arrivals,4);
+        for(int i=0;i<n.periodic;i++)putName(n.tasks[i]);
+        for(size_t i=0;i<arrivals;i++)putName(n.arrival(i));
+    }
+    void putName(const string& name){
+        put(name.size(),2);
+        out.write(name.data(),name.size());
+    }
+    void put(unsigned long long v,int bytes){
+        char b[8];
+        for(int i=0;i<bytes;i++)b[i]=(char)(v>>(8*i));
+        out.write(b,bytes);
+    }
+    void emit(const Segment& s) override{
+        int name=s.kind==SEG_IDLE?-1:s.kind==SEG_TASK?s.job:names.periodic+s.job;
+        put((unsigned long long)s.start,8);
+        put((unsigned long long)s.end,8);
+        put((unsigned)name,4);
+        put(s.overhead?4:s.kind,1);
+    }
+};
+
+// non-negative values: exact below 128, then 16 buckets per power of two (within 1/16)
+class Histogram{
+public:
+    Histogram(){ fill(buckets,buckets+BUCKETS,0); }
+    void add(long long v){
+        if(v<0)v=0;
+        buckets[bucket(v)]++;
+        if(n==0 || v<low)low=v;
+        if(n==0 || v>high)high=v;
+        n++;
+        total+=v;
+    }
+    // the values of o added to these
+    void merge(const Histogram& o){
+        if(o.n==0)return;
+        for(int b=0;b<BUCKETS;b++)buckets[b]+=o.buckets[b];
+        if(n==0 || o.low<low)low=o.low;
+        if(n==0 || o.high>high)high=o.high;
+        n+=o.n;
+        total+=o.total;
+    }
+    long long count() const { return n; }
+    long long min() const { return low; }
+    long long max() const { return high; }
+    double mean() const { return n?(double)total/n:0; }
+    // nearest rank, reported as the top of its bucket but never above the maximum
+    long long percentile(int p) const{
+        long long rank=(n*p+99)/100,seen=0;
+        for(int b=0;b<BUCKETS;b++){
+            seen+=buckets[b];
+            if(seen>=rank && seen>0)return std::min(top(b),high);
         }
+        return high;
+    }
+private:
+    static const int EXACT=128;
+    static const int SUB=16;
+    static const int BUCKETS=EXACT+SUB*(63-7);
+    static int bucket(long long v){
+        if(v<EXACT)return v;
+        int octave=7;
+        while(v>>(octave+1))octave++;
+        return EXACT+(octave-7)*SUB+(int)((v>>(octave-4))&(SUB-1));
+    }
+    static long long top(int b){
+        if(b<EXACT)return b;
+        int octave=7+(b-EXACT)/SUB;
+        long long width=1LL<<(octave-4);
+        return (SUB+(b-EXACT)%SUB)*width+width-1;
+    }
+    long long buckets[BUCKETS];
+    long long n=0;
+    long long total=0;
+    long long low=0;
+    long long high=0;
+};
+
+// what happens to a job that misses its deadline
+enum MissPolicy{
+    MISS_ABORT,     // the run stops at the first miss
+    MISS_SKIP,      // the late job is dropped, its task goes on with the next release
+    MISS_CONTINUE   // the late job runs to completion, the next jobs of its task wait for it
+};
 
-        for (auto &task : currentTasks) if(task.release_time<=time)task.isActive=true;
+// what preempting costs and when it is allowed; the defaults keep preemption free and immediate
+struct PreemptionModel{
+    long long switchCost=0;    // time units of every dispatch of a different job
+    vector<long long> reload;  // per periodic task: cache reload (CRPD) when a preempted job resumes
+    vector<long long> region;  // per periodic task: floating non-preemptive region, 0 fully preemptive
+    vector<int> threshold;     // per periodic task under fixed priorities: the task whose level is its
+                               // preemption threshold, empty for none
+    long long laxityThreshold=0; // ELLF: laxity margin a waiting job with a later deadline needs to preempt
+    bool costs() const { return switchCost>0 || !reload.empty(); }
+    bool active() const { return costs() || !region.empty() || !threshold.empty(); }
+};
 
-        sortByExplicitPriority(currentTasks);
-        int runningTaskIndex=0;
+// splitmix64, the same stream on every platform and standard library (as in taskgen.cpp)
+struct Random{
+    unsigned long long state;
+    Random(unsigned long long seed=1):state(seed){}
+    unsigned long long next(){
+        unsigned long long z=(state+=0x9E3779B97F4A7C15ULL);
+        z=(z^(z>>30))*0xBF58476D1CE4E5B9ULL;
+        z=(z^(z>>27))*0x94D049BB133111EBULL;
+        return z^(z>>31);
+    }
+    double uniform(){ return (next()>>11)*0x1.0p-53; } // [0,1)
+    long long between(long long lo,long long hi){       // [lo,hi]
+        return min(hi,lo+(long long)(uniform()*((double)hi-lo+1)));
+    }
+    double normal(){                                    // Box-Muller, mean 0 and deviation 1
+        double u=1-uniform();
+        return sqrt(-2*log(u))*cos(6.283185307179586*uniform());
+    }
+};
 
-        for (auto &task : currentTasks){
-            if(task.isActive==false)runningTaskIndex++;
-            else break;
+// execution time of a job in percent of its task's WCET, never above the WCET nor below 1
+struct ExecDistribution{
+    enum Kind{WCET,UNIFORM,NORMAL} kind=WCET;
+    double a=100,b=100;    // UNIFORM: low and high, NORMAL: mean and deviation
+    long long draw(long long wcet,Random& rng) const{
+        if(kind==UNIFORM){
+            long long lo=max(1LL,min(wcet,(long long)ceil(wcet*a/100-1e-9)));
+            long long hi=max(lo,min(wcet,(long long)floor(wcet*b/100+1e-9)));
+            return rng.between(lo,hi);
         }
-        if(runningTaskIndex==currentTasks.size()){
-            cout<<time<<" is IDLE\n";
-            continue;
+        if(kind==NORMAL){
+            double x=wcet*(a+b*rng.normal())/100;
+            return x>=wcet?wcet:max(1LL,(long long)llround(x));
         }
-        cout<<"At time: "<< time<<" Task" << currentTasks[runningTaskIndex].id<<" is running\n";
+        return wcet;
+    }
+};
+
+// how the jobs of the periodic tasks deviate from the worst case: shorter execution times,
+// sporadic arrivals (the period is the minimum inter-arrival time) and release jitter (the job is
+// released up to J after it arrives; its deadline still counts from the arrival). Every run draws
+// from its own Random seeded with seed, so a seed always gives the same schedule.
+struct JobVariation{
+    vector<ExecDistribution> exec; // per periodic task, empty: every job runs its WCET
+    vector<long long> sporadic;    // per periodic task: largest extra gap after the period, uniform
+    vector<long long> jitter;      // per periodic task: largest release jitter, uniform
+    unsigned long long seed=1;
+    bool active() const { return !exec.empty() || !sporadic.empty() || !jitter.empty(); }
+};
+
+// deadline misses of one task in a run that goes on after them
+struct TaskOverload{
+    string id;
+    long long jobs=0;          // jobs whose deadline has come: finished in time or missed
+    long long missed=0;
+    long long streak=0;        // misses in a row so far
+    long long longestStreak=0; // how many jobs in a row one overload takes down (domino effect)
+    Histogram tardiness;       // finish - deadline of the late jobs that finished (continue)
+    void hit(){ jobs++; streak=0; }
+    void miss(){ jobs++; missed++; longestStreak=max(longestStreak,++streak); }
+};
+
+// the aperiodics one declared server served
+struct ClassResponse{
+    string server;                  // its name, which is the class tag of its A lines
+    vector<long long> response;     // completion minus release, in completion order
+    int pending=0;
+};
+
+struct SimResult{
+    bool missed=false;
+    string missId;
+    long long missTime=0;
+    long long simulatedUntil=0; // time units covered by the run
+    bool bounded=false;     // --horizon ended the run before the hyperperiod
+    long long segments=0;   // scheduling decisions taken
+    long long preemptions=0;         // unfinished periodic jobs or server executions switched out
+    vector<long long> aperiodicResponse; // completion minus release of the served aperiodics, in release order
+    int aperiodicPending=0;          // aperiodics not finished when the simulation stopped
+    vector<TaskOverload> overload;   // per periodic task when the run goes on after misses
+    bool modelled=false;             // a PreemptionModel was in effect, the counters below are kept
+    long long switches=0;            // dispatches that paid a switch or reload
+    long long overhead=0;            // time units spent switching and reloading
+    long long deferredPreemptions=0; // held back by a non-preemptive region
+    long long avoidedPreemptions=0;  // never happened: the job finished inside its region, or the threshold refused it
+    bool steadyStateChecked=false;   // --steady-state: release instants were compared
+    long long cycleStart=-1;         // the state of this instant came back cycleLength later, the run stopped there
+    long long cycleLength=0;
+    vector<ClassResponse> classes;   // servers declared in the input: the aperiodics by class
+};
+
+struct ResponseStats{
+    double mean=0;
+    long long p95=0;      // nearest rank
+    long long p99=0;
+    long long max=0;
+};
+
+ResponseStats responseStats(vector<long long> responses){
+    ResponseStats st;
+    if(responses.empty())return st;
+    sort(responses.begin(),responses.end());
+    double sum=0;
+    for(long long x:responses)sum+=x;
+    st.mean=(double)sum/responses.size();
+    st.p95=responses[(responses.size()*95+99)/100-1];
+    st.p99=responses[(responses.size()*99+99)/100-1];
+    st.max=responses.back();
+    return st;
+}
+
+struct OverloadTotals{
+    long long jobs=0;
+    long long missed=0;
+    int tasksMissing=0;       // tasks with at least one miss
+    long long longestStreak=0;
+    long long maxTardiness=0;
+};
+
+OverloadTotals overloadTotals(const vector<TaskOverload>& tasks){
+    OverloadTotals t;
+    for(const auto& o:tasks){
+        t.jobs+=o.jobs;
+        t.missed+=o.missed;
+        if(o.missed)t.tasksMissing++;
+        t.longestStreak=max(t.longestStreak,o.longestStreak);
+        if(o.tardiness.count())t.maxTardiness=max(t.maxTardiness,o.tardiness.max());
+    }
+    return t;
+}
+
+// ---------------- metrics ----------------
+// Collected only when a RunMetrics is handed to the simulator (--metrics); otherwise the
+// simulator skips every hook on a null pointer. All counters have a fixed size, however long
+// the run.
+
+struct TaskMetrics{
+    Histogram response;               // finish - release of every completed job
+    long long preemptions=0;
+    long long minLatency=LLONG_MAX;   // first start - release: release jitter is max - min
+    long long maxLatency=LLONG_MIN;
+    long long minSlack=LLONG_MAX;     // deadline - finish
+    long long slackSum=0;
+};
+
+struct RunMetrics{
+    vector<string> ids;               // periodic tasks, by task number
+    vector<TaskMetrics> tasks;
+    Histogram aperiodic;              // aperiodic response times
+    long long contextSwitches=0;      // segments whose job differs from the previous one, idle aside
+    long long idle=0;
+    long long simulated=0;
+    int lastKind=-1;
+    int lastJob=-1;
+
+    void begin(const JobNames& names){
+        ids.assign(names.tasks.begin(),names.tasks.begin()+names.periodic);
+        tasks.assign(names.periodic,TaskMetrics());
+    }
+    void segment(const Segment& s){
+        simulated+=s.end-s.start;
+        if(s.kind==SEG_IDLE)idle+=s.end-s.start;
+        else if(s.kind!=lastKind || s.job!=lastJob)contextSwitches++;
+        lastKind=s.kind;
+        lastJob=s.job;
+    }
+    void completed(int task,long long release,long long start,long long finish,long long deadline){
+        TaskMetrics& t=tasks[task];
+        t.response.add(finish-release);
+        t.minLatency=min(t.minLatency,start-release);
+        t.maxLatency=max(t.maxLatency,start-release);
+        t.minSlack=min(t.minSlack,deadline-finish);
+        t.slackSum+=deadline-finish;
+    }
+};
 
-        currentTasks[runningTaskIndex].remaining_exec--;
-        if(currentTasks[runningTaskIndex].remaining_exec==0){
-            Task oldTask=currentTasks[runningTaskIndex];
-            Task newTask=oldTask;
+string jsonString(const string& text){
+    string out="\"";
+    for(char c:text){
+        if(c=='"' || c=='\\'){
+            out+='\\';
+            out+=c;
+        }else if((unsigned char)c<0x20){
+            char hex[8];
+            snprintf(hex,sizeof hex,"\\u%04x",c);
+            out+=hex;
+        }else out+=c;
+    }
+    return out+"\"";
+}
 
-            newTask.isActive=false;
-            newTask.release_time=oldTask.release_time+oldTask.period;
-            newTask.absolute_deadline=newTask.release_time+newTask.deadline_relative;
-            newTask.remaining_exec=newTask.exec_time;
+void writeHistogram(ostream& out,const Histogram& h){
+    out<<"{\"min\":"<<h.min()<<",\"mean\":"<<h.mean()<<",\"p50\":"<<h.percentile(50)<<",\"p95\":"<<h.percentile(95)
+       <<",\"p99\":"<<h.percentile(99)<<",\"max\":"<<h.max()<<"}";
+}
 
-            currentTasks.erase(currentTasks.begin()+runningTaskIndex);
-            currentTasks.push_back(newTask);
+// one JSON object on one line; head holds the fields naming the run, each followed by a comma
+void writeMetrics(ostream& stream,const string& head,const RunMetrics& m,const SimResult& r){
+    ostringstream out; // default number format whatever the stream was left with
+    out<<"{"<<head<<"\"schedulable\":"<<(r.missed?"false":"true")<<",\"first_miss\":";
+    if(r.missed)out<<"{\"task\":"<<jsonString(r.missId)<<",\"time\":"<<r.missTime<<"}";
+    else out<<"null";
+    out<<",\"simulated\":"<<m.simulated<<",\"context_switches\":"<<m.contextSwitches
+       <<",\"preemptions\":"<<r.preemptions<<",\"idle_time\":"<<m.idle
+       <<",\"idle_ratio\":"<<(m.simulated?(double)m.idle/m.simulated:0)<<",\"tasks\":[";
+    for(size_t i=0;i<m.tasks.size();i++){
+        const TaskMetrics& t=m.tasks[i];
+        out<<(i?",":"")<<"{\"id\":"<<jsonString(m.ids[i])<<",\"jobs\":"<<t.response.count()
+           <<",\"preemptions\":"<<t.preemptions<<",\"response\":";
+        if(t.response.count()==0){
+            out<<"null,\"release_jitter\":null,\"finishing_jitter\":null,\"slack\":null}";
+            continue;
+        }
+        writeHistogram(out,t.response);
+        out<<",\"release_jitter\":"<<t.maxLatency-t.minLatency
+           <<",\"finishing_jitter\":"<<t.response.max()-t.response.min()
+           <<",\"slack\":{\"min\":"<<t.minSlack<<",\"mean\":"<<(double)t.slackSum/t.response.count()<<"}}";
+    }
+    out<<"],\"aperiodic\":{\"served\":"<<m.aperiodic.count()<<",\"pending\":"<<r.aperiodicPending<<",\"response\":";
+    if(m.aperiodic.count())writeHistogram(out,m.aperiodic);
+    else out<<"null";
+    if(!r.classes.empty()){
+        out<<",\"classes\":[";
+        for(size_t k=0;k<r.classes.size();k++){
+            const ClassResponse& c=r.classes[k];
+            Histogram h;
+            for(long long x:c.response)h.add(x);
+            out<<(k?",":"")<<"{\"server\":"<<jsonString(c.server)<<",\"served\":"<<h.count()
+               <<",\"pending\":"<<c.pending<<",\"response\":";
+            if(h.count())writeHistogram(out,h);
+            else out<<"null";
+            out<<"}";
+        }
+        out<<"]";
+    }
+    out<<"}";
+    if(r.modelled)
+        out<<",\"preemption_model\":{\"switches\":"<<r.switches<<",\"switch_overhead\":"<<r.overhead
+           <<",\"deferred_preemptions\":"<<r.deferredPreemptions<<",\"avoided_preemptions\":"<<r.avoidedPreemptions<<"}";
+    if(!r.overload.empty()){
+        OverloadTotals t=overloadTotals(r.overload);
+        out<<",\"overload\":{\"jobs\":"<<t.jobs<<",\"missed\":"<<t.missed<<",\"miss_ratio\":"
+           <<(t.jobs?(double)t.missed/t.jobs:0)<<",\"tasks_missing\":"<<t.tasksMissing<<",\"tasks\":[";
+        for(size_t i=0;i<r.overload.size();i++){
+            const TaskOverload& o=r.overload[i];
+            out<<(i?",":"")<<"{\"id\":"<<jsonString(o.id)<<",\"jobs\":"<<o.jobs<<",\"missed\":"<<o.missed
+               <<",\"miss_ratio\":"<<(o.jobs?(double)o.missed/o.jobs:0)<<",\"longest_streak\":"<<o.longestStreak
+               <<",\"tardiness\":";
+            if(o.tardiness.count())writeHistogram(out,o.tardiness);
+            else out<<"null";
+            out<<"}";
         }
+        out<<"]}";
     }
-    cout<<"Successfully scheduled until hyperperiod.\n";
+    out<<"}\n";
+    stream<<out.str();
 }
 
-void deadlineMonotonic(vector<Task> &tasks){
-    if(!checkFeasibility(tasks)){
-        cout<<"This task set is not schedulable";
-        return;
+// binary min-heap over entry indices that remembers where every entry sits,
+// so an entry can be re-keyed or removed in O(log n)
+template<class Less>
+class IndexedHeap{
+public:
+    IndexedHeap(Less less):less(less){}
+    void reset(int n){ heap.clear(); pos.assign(n,-1); }
+    bool empty() const { return heap.empty(); }
+    int size() const { return heap.size(); }
+    int top() const { return heap[0]; }
+    int at(int slot) const { return heap[slot]; }
+    bool contains(int i) const { return pos[i]>=0; }
+    // best entry after the top one
+    int second() const{
+        if(heap.size()<2)return -1;
+        if(heap.size()==2 || less(heap[1],heap[2]))return heap[1];
+        return heap[2];
     }
-     for (auto &t : tasks) {
-        t.priority       = 1.0f / t.deadline_relative; //only difference here
-        t.absolute_deadline = t.release_time + t.deadline_relative;
-        t.remaining_exec = t.exec_time;
-        t.isActive       = false;
+    void push(int i){
+        pos[i]=heap.size();
+        heap.push_back(i);
+        siftUp(pos[i]);
     }
-    
-    int hyperperiod=calculate_hyperperiod(tasks);
-    int firstSimoultaneous=findFirstSimultaneousRelease(tasks);
-    vector<Task> currentTasks=tasks;
-    for(int time=0; time<hyperperiod+firstSimoultaneous+1; time++){
-        for(auto &ct:currentTasks){
-            if(ct.absolute_deadline<=time){
-                cout<<"Deadline missed for "<< ct.id<<" at " <<time <<". Algorithm is failed.\n";
-                return;
+    int pop(){
+        int i=heap[0];
+        erase(i);
+        return i;
+    }
+    void erase(int i){
+        int k=pos[i];
+        int last=heap.back();
+        heap.pop_back();
+        pos[i]=-1;
+        if(k<(int)heap.size()){
+            place(k,last);
+            siftUp(k);
+            siftDown(pos[last]);
+        }
+    }
+    // restores the order after the key of i changed
+    void update(int i){
+        siftUp(pos[i]);
+        siftDown(pos[i]);
+    }
+private:
+    vector<int> heap;
+    vector<int> pos;
+    Less less;
+    void place(int k,int i){ heap[k]=i; pos[i]=k; }
+    void siftUp(int k){
+        int i=heap[k];
+        while(k>0){
+            int parent=(k-1)/2;
+            if(!less(i,heap[parent]))break;
+            place(k,heap[parent]);
+            k=parent;
+        }
+        place(k,i);
+    }
+    void siftDown(int k){
+        int i=heap[k];
+        int n=heap.size();
+        while(true){
+            int child=2*k+1;
+            if(child>=n)break;
+            if(child+1<n && less(heap[child+1],heap[child]))child++;
+            if(!less(heap[child],i))break;
+            place(k,heap[child]);
+            k=child;
+        }
+        place(k,i);
+    }
+};
+
+// state of the single outstanding job of a periodic task (or of the server task)
+struct EventJob{
+    long long release;
+    long long deadline;
+    long long remaining;
+    long long arrival;  // release before jitter, the deadline and response time count from here
+    long long seq;      // position among equal static priorities: initial index, renewed on every completion
+    long long stamp=0;  // tie order among equal EDF deadlines / LLF keys
+    long long key=0;    // EDF: absolute deadline, LLF: deadline-remaining, taken at the last decision
+    bool active=false;
+    bool fresh=false;   // created by a completion at the current instant
+    long long start=-1; // first dispatch of the current job, kept for metrics only
+    bool late=false;    // missed its deadline and runs on (MISS_CONTINUE)
+    int level=0;        // fixed priority policies: priority, raised to the threshold once started
+    bool boosted=false; // runs at its preemption threshold
+    bool preempted=false; // switched out unfinished, pays the cache reload when it resumes
+};
+
+// static parameters of the tasks a simulator runs, one array per field indexed by task number
+struct TaskTable{
+    vector<long long> release;  // first release
+    vector<long long> exec;
+    vector<long long> period;
+    vector<long long> deadline; // relative
+    vector<int> priority;     // fixed priority policies: level, higher runs first
+    void add(const Task& t,int p){
+        release.push_back(t.release_time);
+        exec.push_back(t.exec_time);
+        period.push_back(t.period);
+        deadline.push_back(t.deadline_relative);
+        priority.push_back(p);
+    }
+    int size() const { return period.size(); }
+};
+
+// ---------------- input ----------------
+// Task files are mapped into memory and scanned in place: no line copies and no streams. Job
+// numbers stay integers until a Task is built, which is when they become "T<n>"/"A<n>".
+
+// read-only view of a whole file: mmap on POSIX, a file mapping on Windows, and the contents
+// read into memory when the file cannot be mapped (pipes, special files)
+class MappedFile{
+public:
+    MappedFile(const string& filename){
+#ifdef _WIN32
+        file=CreateFileA(filename.c_str(),GENERIC_READ,FILE_SHARE_READ,nullptr,OPEN_EXISTING,
+                         FILE_ATTRIBUTE_NORMAL,nullptr);
+        LARGE_INTEGER size;
+        if(file!=INVALID_HANDLE_VALUE && GetFileSizeEx(file,&size)){
+            open=true;
+            length=(size_t)size.QuadPart;
+            if(length>0 && (mapping=CreateFileMappingA(file,nullptr,PAGE_READONLY,0,0,nullptr)))
+                data=(const char*)MapViewOfFile(mapping,FILE_MAP_READ,0,0,0);
+        }
+#else
+        int fd=::open(filename.c_str(),O_RDONLY);
+        struct stat info;
+        if(fd>=0 && fstat(fd,&info)==0 && S_ISREG(info.st_mode)){
+            open=true;
+            length=(size_t)info.st_size;
+            if(length>0){
+                void* view=mmap(nullptr,length,PROT_READ,MAP_PRIVATE,fd,0);
+                if(view!=MAP_FAILED){
+                    data=(const char*)view;
+                    madvise(view,length,MADV_SEQUENTIAL);
+                }
+            }
+        }
+        if(fd>=0)::close(fd);
+#endif
+        if(open && (length==0 || data))return;
+        // not mappable: read it
+        ifstream in(filename,ios::binary);
+        open=in.is_open();
+        if(open){
+            copy.assign(istreambuf_iterator<char>(in),istreambuf_iterator<char>());
+            length=copy.size();
+        }
+    }
+    ~MappedFile(){
+        if(copy.empty() && data){
+#ifdef _WIN32
+            UnmapViewOfFile(data);
+#else
+            munmap((void*)data,length);
+#endif
+        }
+#ifdef _WIN32
+        if(mapping)CloseHandle(mapping);
+        if(file!=INVALID_HANDLE_VALUE)CloseHandle(file);
+#endif
+    }
+    MappedFile(const MappedFile&)=delete;
+    MappedFile& operator=(const MappedFile&)=delete;
+    bool isOpen() const { return open; }
+    const char* begin() const { return copy.empty()?data:copy.data(); }
+    const char* end() const { return begin()+length; }
+    size_t size() const { return length; }
+private:
+    const char* data=nullptr;
+    size_t length=0;
+    bool open=false;
+    string copy;
+#ifdef _WIN32
+    HANDLE file=INVALID_HANDLE_VALUE;
+    HANDLE mapping=nullptr;
+#endif
+};
+
+// one line of a task file, split like "stream >> type" followed by ">> long long" until it fails
+struct TaskLine{
+    const char* begin=nullptr;  // the line as written (without the newline), for messages
+    const char* end=nullptr;
+    char type=0;                // 'P', 'D', 'A' or 'S' when the first word is that letter alone
+    int count=0;                // integers after the first word
+    long long values[4];        // the first four of them
+    const char* word=nullptr;   // the word the integers stop at (an A line's class), wordLength 0 if none
+    size_t wordLength=0;
+    string text() const { return string(begin,end); }
+};
+
+inline bool isBlank(char c){ return c==' ' || c=='\t' || c=='\r' || c=='\v' || c=='\f' || c=='\n'; }
+
+// the next line from p on, false at the end of the input
+bool nextLine(const char*& p,const char* end,TaskLine& line){
+    if(p>=end)return false;
+    const char* newline=(const char*)memchr(p,'\n',end-p);
+    line.begin=p;
+    line.end=newline?newline:end;
+    p=newline?newline+1:end;
+
+    const char* c=line.begin;
+    const char* e=line.end;
+    while(c<e && isBlank(*c))c++;
+    const char* word=c;
+    while(c<e && !isBlank(*c))c++;
+    line.type=(c-word==1 && (*word=='P' || *word=='D' || *word=='A' || *word=='S'))?*word:0;
+    line.count=0;
+    // integers as operator>> reads them: optional sign, digits, and no overflow
+    while(true){
+        while(c<e && isBlank(*c))c++;
+        bool negative=false;
+        if(c<e && (*c=='-' || *c=='+'))negative=*c++=='-';
+        if(c>=e || *c<'0' || *c>'9')break;
+        long long v=0;
+        bool overflow=false;
+        while(c<e && *c>='0' && *c<='9'){
+            int digit=*c++-'0';
+            if(v>(LLONG_MAX-digit)/10){
+                overflow=true;
+                break;
             }
+            v=v*10+digit;
         }
+        if(overflow)break;
+        if(line.count<4)line.values[line.count]=negative?-v:v;
+        line.count++;
+    }
+    line.word=c;
+    while(c<e && !isBlank(*c))c++;
+    line.wordLength=c-line.word;
+    return true;
+}
+
+// ---------------- aperiodic arrivals ----------------
+// The simulator pulls aperiodic jobs in release order from a source, so a long arrival trace
+// never has to be in memory at once.
+
+// an aperiodic job on its way through the simulator
+struct AperiodicJob{
+    int id;              // numbers the arrivals of a source, 0 up; the source knows its name
+    long long release;
+    long long remaining;
+    long long deadline;  // total bandwidth server deadline
+};
+
+struct ArrivalSource{
+    virtual void rewind()=0;                 // back to the first arrival, every simulation starts here
+    virtual bool next(AperiodicJob& j)=0;    // the next arrival in release order, false at the end
+    virtual size_t remaining() const=0;      // arrivals not handed out yet
+    virtual size_t count() const=0;          // arrivals in all, the ids are 0 to count-1
+    virtual string name(int id) const=0;     // the input file's id of an arrival
+    virtual string tag(int) const { return ""; } // its class, the declared server it goes to
+    virtual ~ArrivalSource(){}
+};
+
+string JobNames::job(const Segment& s) const{
+    if(s.kind==SEG_IDLE)return "";
+    if(s.kind==SEG_TASK)return tasks[s.job];
+    return arrival(s.job);
+}
+
+size_t JobNames::arrivalCount() const { return arrivals?arrivals->count():0; }
+string JobNames::arrival(int id) const { return arrivals->name(id); }
 
-        for (auto &task : currentTasks) if(task.release_time<=time)task.isActive=true;
+// arrivals kept in memory, handed out stably sorted by release time
+class VectorArrivals:public ArrivalSource{
+public:
+    VectorArrivals(const vector<Task>& tasks):tasks(tasks),order(tasks.size()){
+        for(size_t i=0;i<order.size();i++)order[i]=i;
+        stable_sort(order.begin(),order.end(),[&tasks](int a,int b){
+            return tasks[a].release_time<tasks[b].release_time;
+        });
+    }
+    void rewind() override{ position=0; }
+    bool next(AperiodicJob& j) override{
+        if(position>=order.size())return false;
+        int id=order[position++];
+        j={id,tasks[id].release_time,tasks[id].exec_time,LLONG_MAX};
+        return true;
+    }
+    size_t remaining() const override{ return order.size()-position; }
+    size_t count() const override{ return tasks.size(); }
+    string name(int id) const override{ return tasks[id].id; }
+    string tag(int id) const override{ return tasks[id].tag; }
+private:
+    const vector<Task>& tasks;
+    vector<int> order;
+    size_t position=0;
+};
 
-        sortByExplicitPriority(currentTasks);
-        int runningTaskIndex=0;
+// the arrivals of one class, taken from another source in its release order; ids and names stay
+// those of that source
+class ClassArrivals:public ArrivalSource{
+public:
+    ClassArrivals(const ArrivalSource& all):all(all){}
+    void add(const AperiodicJob& j){ jobs.push_back(j); }
+    void rewind() override{ position=0; }
+    bool next(AperiodicJob& j) override{
+        if(position>=jobs.size())return false;
+        j=jobs[position++];
+        return true;
+    }
+    size_t remaining() const override{ return jobs.size()-position; }
+    size_t count() const override{ return jobs.size(); }
+    string name(int id) const override{ return all.name(id); }
+    string tag(int id) const override{ return all.tag(id); }
+private:
+    const ArrivalSource& all;
+    vector<AperiodicJob> jobs;
+    size_t position=0;
+};
 
-        for (auto &task : currentTasks){
-            if(task.isActive==false)runningTaskIndex++;
-            else break;
+// A lines scanned from the mapped input file while simulating; the file must list them in
+// release order
+class FileArrivals:public ArrivalSource{
+public:
+    FileArrivals(shared_ptr<MappedFile> input,size_t count):input(input),arrivals(count){}
+    void rewind() override{
+        position=input->begin();
+        pulled=0;
+    }
+    // malformed A lines were reported when the file was first scanned
+    bool next(AperiodicJob& j) override{
+        TaskLine line;
+        while(nextLine(position,input->end(),line)){
+            if(line.type!='A' || line.count!=2)continue;
+            j={(int)pulled++,line.values[0],line.values[1],LLONG_MAX};
+            return true;
         }
-        if(runningTaskIndex==currentTasks.size()){
-            cout<<time<<" is IDLE\n";
-            continue;
+        return false;
+    }
+    size_t remaining() const override{ return arrivals-pulled; }
+    size_t count() const override{ return arrivals; }
+    string name(int id) const override{ return "A"+to_string(id+1); }
+private:
+    shared_ptr<MappedFile> input;
+    size_t arrivals;
+    const char* position=nullptr;
+    size_t pulled=0;
+};
+
+// aperiodic jobs in release order: the released, unfinished ones in a FIFO whose size is the
+// ready count, the pending ones still in the source behind a one job lookahead
+class AperiodicQueue{
+public:
+    AperiodicQueue(ArrivalSource& source):source(source){
+        source.rewind();
+        hasNext=source.next(lookahead);
+    }
+    long long nextRelease() const { return hasNext?lookahead.release:LLONG_MAX; }
+    void releaseOne(){
+        ready.push_back(lookahead);
+        hasNext=source.next(lookahead);
+    }
+    bool hasReady() const { return !ready.empty(); }
+    size_t readyCount() const { return ready.size(); }
+    AperiodicJob& front(){ return ready.front(); }
+    AperiodicJob& back(){ return ready.back(); }
+    void pop(){ ready.pop_front(); }
+    bool done() const { return ready.empty() && !hasNext; }
+    size_t unfinished() const { return ready.size()+(hasNext?1:0)+source.remaining(); }
+    deque<AperiodicJob>::const_iterator begin() const { return ready.begin(); }
+    deque<AperiodicJob>::const_iterator end() const { return ready.end(); }
+private:
+    ArrivalSource& source;
+    deque<AperiodicJob> ready;
+    AperiodicJob lookahead;
+    bool hasNext=false;
+};
+
+// ---------------- policies ----------------
+// Chosen at compile time by Simulator<PriorityPolicy,ServerPolicy>: every combination gets
+// its own inner loop with the branches on these constants folded away.
+// Fixed priorities are integer levels, one per task and 0 the lowest, given to the whole set at
+// once (the server included, with its release jitter). Equal periods or deadlines go to the
+// task listed first.
+
+// levels in ascending order of key, ties to the lower index
+template<class Key>
+vector<int> levelsBy(const vector<Task>& set,Key key){
+    vector<int> order(set.size());
+    for(size_t i=0;i<order.size();i++)order[i]=i;
+    stable_sort(order.begin(),order.end(),[&](int a,int b){ return key(set[a])<key(set[b]); });
+    vector<int> level(set.size());
+    for(size_t r=0;r<order.size();r++)level[order[r]]=set.size()-1-r;
+    return level;
+}
+
+struct RateMonotonic{
+    static const bool dynamic=false;
+    static const bool laxity=false;
+    static const bool enhanced=false;
+    static vector<int> levels(const vector<Task>& set,const vector<long long>&){
+        return levelsBy(set,[](const Task& t){ return t.period; });
+    }
+    static long long key(const EventJob&){ return 0; }
+};
+
+struct DeadlineMonotonic{
+    static const bool dynamic=false;
+    static const bool laxity=false;
+    static const bool enhanced=false;
+    static vector<int> levels(const vector<Task>& set,const vector<long long>&){
+        return levelsBy(set,[](const Task& t){ return t.deadline_relative; });
+    }
+    static long long key(const EventJob&){ return 0; }
+};
+
+// the order Audsley's algorithm finds with the response time test, DM when there is none
+struct AudsleyOptimal{
+    static const bool dynamic=false;
+    static const bool laxity=false;
+    static const bool enhanced=false;
+    static vector<int> levels(const vector<Task>& set,const vector<long long>& jitter){
+        return optimalPriorityLevels(set,jitter);
+    }
+    static long long key(const EventJob&){ return 0; }
+};
+
+struct EarliestDeadlineFirst{
+    static const bool dynamic=true;
+    static const bool laxity=false;
+    static const bool enhanced=false;
+    static vector<int> levels(const vector<Task>& set,const vector<long long>&){ return vector<int>(set.size(),0); }
+    static long long key(const EventJob& j){ return j.deadline; }
+};
+
+struct LeastLaxityFirst{
+    static const bool dynamic=true;
+    static const bool laxity=true;
+    static const bool enhanced=false; // a waiting job takes over as soon as its laxity is the lower one
+    static vector<int> levels(const vector<Task>& set,const vector<long long>&){ return vector<int>(set.size(),0); }
+    static long long key(const EventJob& j){ return (long long)j.deadline-j.remaining; } // laxity + time, constant while waiting
+};
+
+// modified LLF (Oh and Yang): the running job keeps the processor through laxity ties and crossings
+// while its deadline is not later than the waiting job's, or the waiting job's laxity is lower by
+// no more than PreemptionModel::laxityThreshold; a waiting job at zero laxity always takes over.
+// No more equal laxity jobs taking turns every time unit.
+struct EnhancedLeastLaxityFirst{
+    static const bool dynamic=true;
+    static const bool laxity=true;
+    static const bool enhanced=true;
+    static vector<int> levels(const vector<Task>& set,const vector<long long>&){ return vector<int>(set.size(),0); }
+    static long long key(const EventJob& j){ return (long long)j.deadline-j.remaining; }
+};
+
+enum ServerKind{SERVER_BG,SERVER_POLLER,SERVER_DS,SERVER_SS,SERVER_TBS,SERVER_CBS};
+
+ServerKind serverKind(const string& type){
+    if(type=="POLLER")return SERVER_POLLER;
+    if(type=="DS")return SERVER_DS;
+    if(type=="SS")return SERVER_SS;
+    if(type=="TBS")return SERVER_TBS;
+    if(type=="CBS")return SERVER_CBS;
+    return SERVER_BG;
+}
+
+struct NoServer{
+    static const bool serverTask=false;  // server competes as a periodic task of budget/period
+    static const bool background=false;  // aperiodics run whenever no periodic job is ready
+    static const bool polling=false;     // budget cut to the pending work at every period start
+    static const bool deferrable=false;  // full budget at every period start, kept until used
+    static const bool sporadic=false;    // consumed budget comes back one period after activation
+    static const bool totalBandwidth=false;    // each aperiodic gets deadline max(r,d_prev)+C/Us
+    static const bool constantBandwidth=false; // budget refill postpones the server deadline by a period
+    static const bool declared=false;    // the servers of the input file, each of its own kind
+    static const char* type(){ return ""; }
+};
+
+struct BackgroundServer{
+    static const bool serverTask=false;
+    static const bool background=true;
+    static const bool polling=false;
+    static const bool deferrable=false;
+    static const bool sporadic=false;
+    static const bool totalBandwidth=false;
+    static const bool constantBandwidth=false;
+    static const bool declared=false;
+    static const char* type(){ return "BG"; }
+};
+
+struct PollingServer{
+    static const bool serverTask=true;
+    static const bool background=false;
+    static const bool polling=true;
+    static const bool deferrable=false;
+    static const bool sporadic=false;
+    static const bool totalBandwidth=false;
+    static const bool constantBandwidth=false;
+    static const bool declared=false;
+    static const char* type(){ return "POLLER"; }
+};
+
+struct DeferrableServer{
+    static const bool serverTask=true;
+    static const bool background=false;
+    static const bool polling=false;
+    static const bool deferrable=true;
+    static const bool sporadic=false;
+    static const bool totalBandwidth=false;
+    static const bool constantBandwidth=false;
+    static const bool declared=false;
+    static const char* type(){ return "DS"; }
+};
+
+// fixed priority only: priority of its period, budget replenished by what was consumed
+struct SporadicServer{
+    static const bool serverTask=true;
+    static const bool background=false;
+    static const bool polling=false;
+    static const bool deferrable=false;
+    static const bool sporadic=true;
+    static const bool totalBandwidth=false;
+    static const bool constantBandwidth=false;
+    static const bool declared=false;
+    static const char* type(){ return "SS"; }
+};
+
+// deadline driven only: the server job carries the deadline of the aperiodic it serves
+struct TotalBandwidthServer{
+    static const bool serverTask=true;
+    static const bool background=false;
+    static const bool polling=false;
+    static const bool deferrable=false;
+    static const bool sporadic=false;
+    static const bool totalBandwidth=true;
+    static const bool constantBandwidth=false;
+    static const bool declared=false;
+    static const char* type(){ return "TBS"; }
+};
+
+struct ConstantBandwidthServer{
+    static const bool serverTask=true;
+    static const bool background=false;
+    static const bool polling=false;
+    static const bool deferrable=false;
+    static const bool sporadic=false;
+    static const bool totalBandwidth=false;
+    static const bool constantBandwidth=true;
+    static const bool declared=false;
+    static const char* type(){ return "CBS"; }
+};
+
+// any number of servers of any kind, one per S line of the input, each serving the A lines tagged
+// with its name: the kind is looked up per server at run time instead of folded into the loop
+struct DeclaredServers{
+    static const bool serverTask=false;
+    static const bool background=false;
+    static const bool polling=false;
+    static const bool deferrable=false;
+    static const bool sporadic=false;
+    static const bool totalBandwidth=false;
+    static const bool constantBandwidth=false;
+    static const bool declared=true;
+    static const char* type(){ return "declared"; }
+};
+
+// Scheduler states seen at release instants, for --steady-state. Every time in a state is taken
+// relative to its instant, so a state that comes back means the schedule from then on replays the
+// one from the first time: a deadline met there is met forever. States are kept in full and compared
+// on a hash match; past the memory budget new ones are no longer recorded, only looked up.
+class StateHistory{
+public:
+    // instant of an earlier equal state, -1 if there is none (the state is then recorded)
+    long long match(long long time,const vector<long long>& state){
+        unsigned long long h=state.size();
+        for(long long v:state){
+            // splitmix64 finaliser over the running value
+            h^=(unsigned long long)v+0x9e3779b97f4a7c15ULL+(h<<6)+(h>>2);
+            h=(h^(h>>30))*0xbf58476d1ce4e5b9ULL;
+            h=(h^(h>>27))*0x94d049bb133111ebULL;
+            h^=h>>31;
+        }
+        auto it=index.find(h);
+        int first=it==index.end()?-1:it->second;
+        for(int k=first;k>=0;k=records[k].next){
+            const Record& r=records[k];
+            if(r.size==state.size() && equal(state.begin(),state.end(),values.begin()+r.offset))return r.time;
+        }
+        if(values.size()+state.size()>BUDGET)return -1;
+        records.push_back({time,values.size(),state.size(),first});
+        values.insert(values.end(),state.begin(),state.end());
+        index[h]=records.size()-1;
+        return -1;
+    }
+private:
+    static const size_t BUDGET=size_t(1)<<24; // values kept, 128 MB
+    struct Record{
+        long long time;
+        size_t offset,size;  // in values
+        int next;            // earlier record with the same hash, -1 at the end
+    };
+    unordered_map<unsigned long long,int> index; // hash -> latest record
+    vector<Record> records;
+    vector<long long> values;
+};
+
+// Servers are a vector of states: none, the one of the command line, or the declared ones of the
+// input file, each with its own class of aperiodics. A budgeted server is an entry of the job
+// vector after the periodic tasks and sits in its own ready heap while it may run; its next
+// replenishment or arrival is in an event heap, so a decision stays O(log n) in the tasks and
+// servers and an instant only touches the servers that have something due.
+template<class PriorityPolicy,class ServerPolicy>
+class Simulator{
+public:
+    Simulator(const vector<Task>& tasks,ArrivalSource& arrivals,const vector<DeclaredServer>& servers,
+              TraceSink& sink,bool tickByTick=false,RunMetrics* metrics=nullptr,MissPolicy onMiss=MISS_ABORT,
+              const PreemptionModel* model=nullptr,long long horizon=0,bool steadyState=false,
+              const JobVariation* variation=nullptr);
+    SimResult run();
+private:
+    typedef PriorityPolicy P;
+    typedef ServerPolicy S;
+    struct ReadyOrder{
+        const Simulator* sim;
+        bool operator()(int a,int b) const { return sim->before(a,b); }
+    };
+    struct ReleaseOrder{
+        const Simulator* sim;
+        bool operator()(int a,int b) const{
+            const EventJob &x=sim->jobs[a],&y=sim->jobs[b];
+            if(x.release!=y.release)return x.release<y.release;
+            return x.seq<y.seq;
+        }
+    };
+    struct DeadlineOrder{
+        const Simulator* sim;
+        bool operator()(int a,int b) const { return sim->jobs[a].deadline<sim->jobs[b].deadline; }
+    };
+    struct EventOrder{
+        const Simulator* sim;
+        bool operator()(int a,int b) const{
+            if(sim->servers[a].event!=sim->servers[b].event)return sim->servers[a].event<sim->servers[b].event;
+            return a<b;
+        }
+    };
+    struct DeclarationOrder{
+        bool operator()(int a,int b) const { return a<b; }
+    };
+    struct ServerState{
+        string name;
+        ServerKind kind;
+        int entry=-1;               // its job, -1 for background service
+        long long budget=0;
+        long long period=0;
+        AperiodicQueue aperiodics;  // its class, served first come first served from the front
+        long long event=0;          // next instant that can change its decision, LLONG_MAX if none
+        long long visited=-1;       // last instant it was brought up to date
+        long long tbsDeadline=0;    // total bandwidth: deadline given to the latest arrival
+        vector<pair<long long,long long>> replenishments; // sporadic: (time, amount), time ordered
+        size_t replenishHead=0;
+        long long activeSince=-1;   // sporadic: start of the current active period, -1 idle
+        long long consumed=0;       // sporadic: budget used in the current active period
+        ServerState(ArrivalSource& source):aperiodics(source){}
+    };
+
+    TaskTable table;            // periodic tasks, budgeted servers appended in their order
+    JobNames names;
+    vector<EventJob> jobs;
+    vector<unique_ptr<ClassArrivals>> classes; // declared servers: the arrivals split by class
+    vector<ServerState> servers;
+    vector<int> serverOf;       // by entry minus periodicCount: the server of a budgeted entry
+    IndexedHeap<ReadyOrder> ready;        // periodic jobs released, not finished
+    IndexedHeap<ReadyOrder> serverReady;  // budgeted servers with budget and work to serve
+    IndexedHeap<ReleaseOrder> releases;   // waiting for their release time
+    IndexedHeap<DeadlineOrder> deadlines; // every outstanding job, for the miss check
+    IndexedHeap<EventOrder> events;       // servers by their next event
+    IndexedHeap<DeclarationOrder> backgroundReady; // background servers with released work
+    int periodicCount;
+    long long end;              // hyperperiod after the first simultaneous release, plus one
+    bool bounded=false;         // end is the horizon, before that
+    string warning;             // no simultaneous release, reported when the run starts
+    TraceSink& sink;
+    bool tickByTick;            // stop after every time unit, as the original per-policy loops did
+    RunMetrics* metrics;        // null unless metrics are collected
+    MissPolicy onMiss;
+    PreemptionModel model;
+    long long overheadLeft=0;   // switch and reload time the current job still has to pay
+    long long regionLeft=-1;    // non-preemptive region of the running job, -1 while none is open
+    int lastKind=SEG_IDLE;      // job that ran last, for the switch cost (reset by a completion)
+    int lastJob=-1;
+    int lastServer=-1;          // entry of the server lastJob ran under (SEG_SERVER)
+    long long seqCounter;
+    long long bestStamp=0;
+    long long worstStamp=0;
+    int lastRunning=-1;         // entry that ran in the previous segment
+    int lastBackground=-1;      // background server that ran in the previous segment
+    bool lastFinished=false;    // its job completed or was dropped, the entry holds the next job
+    vector<int> released;       // entries released at the current instant
+    vector<int> changed;        // servers brought up to date at the current instant
+    vector<int> polled;         // pollers that polled at the current instant, their key is stale until the next
+    size_t unfinished;          // aperiodics not served yet
+    bool steadyState;           // compare the state at release instants and stop once one repeats
+    int anchor=-1;              // steadyState: the task with the longest period, its releases are compared
+    StateHistory history;
+    vector<long long> state;    // scratch for captureState
+    vector<int> order;
+    JobVariation variation;     // random execution times and releases, inactive by default
+    Random rng;
+
+    // the kind of a server, a constant unless the servers are declared
+    bool budgeted(const ServerState& s) const { return S::declared?s.kind!=SERVER_BG:S::serverTask; }
+    bool background(const ServerState& s) const { return S::declared?s.kind==SERVER_BG:S::background; }
+    bool polling(const ServerState& s) const { return S::declared?s.kind==SERVER_POLLER:S::polling; }
+    bool deferrable(const ServerState& s) const { return S::declared?s.kind==SERVER_DS:S::deferrable; }
+    bool sporadic(const ServerState& s) const { return S::declared?s.kind==SERVER_SS:S::sporadic; }
+    bool totalBandwidth(const ServerState& s) const { return S::declared?s.kind==SERVER_TBS:S::totalBandwidth; }
+    bool constantBandwidth(const ServerState& s) const { return S::declared?s.kind==SERVER_CBS:S::constantBandwidth; }
+
+    bool before(int a,int b) const;
+    bool reportedBefore(int a,int b) const;
+    bool eligible(const ServerState& s) const;
+    void visit(int k,long long time);
+    void arrive(ServerState& s,long long time);
+    void replenish(ServerState& s,long long time);
+    void poll(ServerState& s);
+    void place(int k,long long time);
+    long long nextEvent(const ServerState& s,long long time) const;
+    void serve(int k,long long finish,SimResult& result);
+    bool arrivalsOver(long long time);
+    int findMissed(long long time) const;
+    void missDeadline(int i,SimResult& result);
+    void renew(int i);
+    void arriveJob(int i,long long arrival);
+    void reorder(int i);
+    void updateStamps(const vector<int>& released);
+    void captureState(long long time);
+};
+
+template<class P,class S>
+Simulator<P,S>::Simulator(const vector<Task>& tasks,ArrivalSource& arrivals,const vector<DeclaredServer>& declared,
+                          TraceSink& sink,bool tickByTick,RunMetrics* metrics,MissPolicy onMiss,
+                          const PreemptionModel* model,long long horizon,bool steadyState,
+                          const JobVariation* variation)
+    :ready(ReadyOrder{this}),serverReady(ReadyOrder{this}),releases(ReleaseOrder{this}),
+     deadlines(DeadlineOrder{this}),events(EventOrder{this}),backgroundReady(DeclarationOrder()),sink(sink),
+     tickByTick(tickByTick),metrics(metrics),onMiss(onMiss),unfinished(arrivals.count()),steadyState(steadyState){
+    if(model)this->model=*model;
+    if(variation && variation->active()){
+        this->variation=*variation;
+        rng=Random(variation->seed);
+        this->steadyState=false; // random jobs do not repeat
+    }
+    if(P::dynamic)this->model.threshold.clear();
+    periodicCount=tasks.size();
+    // several classes are split up front, one server takes the arrivals as they come
+    if(declared.size()>1){
+        unordered_map<string,int> byName;
+        for(size_t k=0;k<declared.size();k++){
+            byName[declared[k].name]=k;
+            classes.emplace_back(new ClassArrivals(arrivals));
         }
-        cout<<"At time: "<< time<<" Task" << currentTasks[runningTaskIndex].id<<" is running\n";
+        arrivals.rewind();
+        for(AperiodicJob a;arrivals.next(a);){
+            auto it=byName.find(arrivals.tag(a.id));
+            classes[it==byName.end()?0:it->second]->add(a); // serverClasses has checked the tags
+        }
+    }
+    servers.reserve(declared.size());
+    vector<Task> all=tasks;
+    for(size_t k=0;k<declared.size();k++){
+        const DeclaredServer& d=declared[k];
+        servers.emplace_back(classes.empty()?arrivals:*classes[k]);
+        ServerState& s=servers.back();
+        s.name=d.name;
+        s.kind=serverKind(d.type);
+        s.budget=d.budget;
+        s.period=d.period;
+        if(budgeted(s)){
+            s.entry=all.size();
+            serverOf.push_back(k);
+            all.push_back(Task(d.name,0,d.budget,d.period,d.period));
+        }
+    }
+    end=simulationEnd(all,&warning);
+    if(horizon>0 && (end<0 || horizon<end)){
+        end=horizon;
+        bounded=true;
+    }
+    // a deferrable server's back to back execution is release jitter to the priority assignment
+    vector<long long> jitter(all.size(),0);
+    for(const auto& s:servers) if(s.entry>=0 && deferrable(s))jitter[s.entry]=s.period-s.budget;
+    vector<int> levels=P::levels(all,jitter);
+    for(size_t i=0;i<all.size();i++){
+        table.add(all[i],levels[i]);
+        names.tasks.push_back(all[i].id);
+    }
+    names.periodic=periodicCount;
+    names.arrivals=&arrivals;
+    int n=table.size();
+    jobs.resize(n);
+    for(int i=0;i<n;i++){
+        arriveJob(i,table.release[i]);
+        jobs[i].seq=i;
+        jobs[i].level=table.priority[i];
+    }
+    seqCounter=n;
+    ready.reset(n);
+    serverReady.reset(n);
+    releases.reset(n);
+    deadlines.reset(n);
+    events.reset(servers.size());
+    backgroundReady.reset(servers.size());
+    for(int i=0;i<periodicCount;i++){
+        releases.push(i);
+        deadlines.push(i);
+    }
+    for(size_t k=0;k<servers.size();k++){
+        if(servers[k].entry>=0 && constantBandwidth(servers[k]))jobs[servers[k].entry].deadline=0;
+        events.push(k); // every server is due at 0
+    }
+    // A repeat needs every task back in phase, so the cycle is a multiple of the hyperperiod and
+    // shows up at any task's releases; the longest period has the fewest to compare.
+    for(int i=0;i<periodicCount;i++)
+        if(anchor<0 || table.period[i]>table.period[anchor])anchor=i;
+}
+
+// priority order; equal keys keep the order a stable sort of the job vector would give them
+template<class P,class S>
+bool Simulator<P,S>::before(int a,int b) const{
+    if(!P::dynamic){
+        if(jobs[a].level!=jobs[b].level)return jobs[a].level>jobs[b].level;
+        if(jobs[a].boosted!=jobs[b].boosted)return jobs[a].boosted; // a started job keeps its threshold
+        return jobs[a].seq<jobs[b].seq;
+    }
+    if(jobs[a].key!=jobs[b].key)return jobs[a].key<jobs[b].key;
+    return jobs[a].stamp<jobs[b].stamp;
+}
+
+// order in which simultaneous misses are reported: the previous decision's order,
+// jobs that just completed last
+template<class P,class S>
+bool Simulator<P,S>::reportedBefore(int a,int b) const{
+    if(jobs[a].fresh!=jobs[b].fresh)return jobs[b].fresh;
+    if(jobs[a].fresh)return jobs[a].seq<jobs[b].seq;
+    if(!P::dynamic)return before(a,b);
+    if(jobs[a].active!=jobs[b].active)return jobs[a].active;
+    if(!jobs[a].active)return jobs[a].seq<jobs[b].seq;
+    if(a==lastRunning || b==lastRunning)return a==lastRunning;
+    return before(a,b);
+}
 
-        currentTasks[runningTaskIndex].remaining_exec--;
-        if(currentTasks[runningTaskIndex].remaining_exec==0){
-            Task oldTask=currentTasks[runningTaskIndex];
-            Task newTask=oldTask;
+// a budgeted server may run: it has budget and, unless it polls, released work
+template<class P,class S>
+bool Simulator<P,S>::eligible(const ServerState& s) const{
+    if(s.entry<0 || !jobs[s.entry].active || jobs[s.entry].remaining==0)return false;
+    return polling(s) || s.aperiodics.hasReady();
+}
 
-            newTask.isActive=false;
-            newTask.release_time=oldTask.release_time+oldTask.period;
-            newTask.absolute_deadline=newTask.release_time+newTask.deadline_relative;
-            newTask.remaining_exec=newTask.exec_time;
+// server k is brought up to date at time (once per instant)
+template<class P,class S>
+void Simulator<P,S>::visit(int k,long long time){
+    if(servers[k].visited==time)return;
+    servers[k].visited=time;
+    changed.push_back(k);
+}
 
-            currentTasks.erase(currentTasks.begin()+runningTaskIndex);
-            currentTasks.push_back(newTask);
+// moves the arrivals up to time into the server's ready FIFO
+template<class P,class S>
+void Simulator<P,S>::arrive(ServerState& s,long long time){
+    while(s.aperiodics.nextRelease()<=time){
+        bool idle=!s.aperiodics.hasReady();
+        s.aperiodics.releaseOne();
+        AperiodicJob& a=s.aperiodics.back();
+        if(totalBandwidth(s)){
+            // d_k = max(r_k, d_k-1) + ceil(C_k / Us) with Us = budget/period
+            s.tbsDeadline=max(a.release,s.tbsDeadline)+mulCeilDiv(a.remaining,s.period,s.budget);
+            a.deadline=s.tbsDeadline;
+        }
+        if(constantBandwidth(s) && idle){
+            // an arrival to an idle server keeps the deadline only while the budget left fits in it
+            EventJob& j=jobs[s.entry];
+            if((WideTime)j.remaining*s.period>=(WideTime)(j.deadline-time)*s.budget){
+                j.deadline=time+s.period;
+                j.remaining=s.budget;
+            }
         }
     }
-    cout<<"Successfully scheduled until hyperperiod.\n";
-}
+}
+
+// what a server does at an instant before the stamps are updated: its first release, the
+// deferrable and sporadic replenishments, the arrivals and the job they make of the server
+template<class P,class S>
+void Simulator<P,S>::replenish(ServerState& s,long long time){
+    if(s.entry>=0 && !jobs[s.entry].active){
+        jobs[s.entry].active=true;
+        released.push_back(s.entry);
+    }
+    if(deferrable(s) && time%s.period==0){
+        EventJob& j=jobs[s.entry];
+        j.remaining=s.budget;
+        j.release=time;
+        j.deadline=time+s.period;
+    }
+    arrive(s,time);
+    if(sporadic(s)){
+        EventJob& j=jobs[s.entry];
+        while(s.replenishHead<s.replenishments.size() && s.replenishments[s.replenishHead].first<=time)
+            j.remaining+=s.replenishments[s.replenishHead++].second;
+        // active from the instant it has both pending work and budget
+        if(s.activeSince<0 && j.remaining>0 && s.aperiodics.hasReady())s.activeSince=time;
+    }
+    if(totalBandwidth(s) && s.aperiodics.hasReady()){
+        jobs[s.entry].deadline=s.aperiodics.front().deadline;
+        jobs[s.entry].remaining=s.aperiodics.front().remaining;
+    }
+}
+
+// the poller only keeps as much budget as the work pending at the polling instant
+template<class P,class S>
+void Simulator<P,S>::poll(ServerState& s){
+    long long usedBudget=0;
+    for(auto a=s.aperiodics.begin();a!=s.aperiodics.end() && usedBudget<s.budget;++a){
+        if(a->remaining<=s.budget-usedBudget)usedBudget+=a->remaining;
+        else usedBudget=s.budget;
+    }
+    jobs[s.entry].remaining=usedBudget;
+}
+
+// server k into the heaps its state at time puts it in
+template<class P,class S>
+void Simulator<P,S>::place(int k,long long time){
+    ServerState& s=servers[k];
+    if(s.entry>=0){
+        bool in=eligible(s);
+        if(in && !serverReady.contains(s.entry))serverReady.push(s.entry);
+        else if(!in && serverReady.contains(s.entry))serverReady.erase(s.entry);
+    }else if(background(s)){
+        bool in=s.aperiodics.hasReady();
+        if(in && !backgroundReady.contains(k))backgroundReady.push(k);
+        else if(!in && backgroundReady.contains(k))backgroundReady.erase(k);
+    }
+    s.event=nextEvent(s,time);
+    if(events.contains(k))events.update(k);
+    else events.push(k);
+}
+
+// the next instant after time at which the server's decision can change by itself: a period start
+// of a poller or deferrable server, a sporadic replenishment, or an arrival that finds it without
+// work (any arrival for constant bandwidth)
+template<class P,class S>
+long long Simulator<P,S>::nextEvent(const ServerState& s,long long time) const{
+    long long next=LLONG_MAX;
+    if(polling(s) || deferrable(s)){
+        long long start=time-time%s.period;
+        next=start>LLONG_MAX-s.period?LLONG_MAX:start+s.period;
+    }
+    if(sporadic(s) && s.replenishHead<s.replenishments.size())
+        next=min(next,s.replenishments[s.replenishHead].first);
+    if(constantBandwidth(s) || (!polling(s) && !s.aperiodics.hasReady()))
+        next=min(next,s.aperiodics.nextRelease());
+    return next;
+}
+
+// the front aperiodic of server k completed at finish
+template<class P,class S>
+void Simulator<P,S>::serve(int k,long long finish,SimResult& result){
+    AperiodicQueue& q=servers[k].aperiodics;
+    long long response=finish-q.front().release;
+    result.aperiodicResponse.push_back(response);
+    if(S::declared)result.classes[k].response.push_back(response);
+    if(metrics)metrics->aperiodic.add(response);
+    q.pop();
+    unfinished--;
+}
+
+// no aperiodic arrives after time; without a server none is ever released, which keeps the
+// steady state check off while there are any
+template<class P,class S>
+bool Simulator<P,S>::arrivalsOver(long long time){
+    if(servers.empty())return unfinished==0;
+    for(auto& s:servers){
+        arrive(s,time);
+        if(s.aperiodics.nextRelease()!=LLONG_MAX)return false;
+    }
+    return true;
+}
+
+// job whose deadline has passed, -1 if none has missed
+template<class P,class S>
+int Simulator<P,S>::findMissed(long long time) const{
+    if(deadlines.empty() || jobs[deadlines.top()].deadline>time)return -1;
+    int missed=-1;
+    vector<int> slots{0};
+    while(!slots.empty()){
+        int slot=slots.back();
+        slots.pop_back();
+        if(slot>=deadlines.size())continue;
+        int i=deadlines.at(slot);
+        if(jobs[i].deadline>time)continue;
+        if(missed<0 || reportedBefore(i,missed))missed=i;
+        slots.push_back(2*slot+1);
+        slots.push_back(2*slot+2);
+    }
+    return missed;
+}
+
+// job i missed its deadline in a run that goes on: it either runs on late, or gives way to
+// the next job of its task
+template<class P,class S>
+void Simulator<P,S>::missDeadline(int i,SimResult& result){
+    result.overload[i].miss();
+    deadlines.erase(i);
+    EventJob& j=jobs[i];
+    if(onMiss==MISS_CONTINUE){
+        j.late=true;
+        return;
+    }
+    if(ready.contains(i))ready.erase(i);
+    if(i==lastRunning)lastFinished=true;
+    if(lastKind==SEG_TASK && lastJob==i)lastKind=SEG_IDLE;
+    renew(i);
+    j.start=-1;
+    releases.push(i);
+    deadlines.push(i);
+}
+
+// the job of entry i that arrives at arrival: released, due and as long as the worst case
+// unless the variation draws otherwise
+template<class P,class S>
+void Simulator<P,S>::arriveJob(int i,long long arrival){
+    EventJob& j=jobs[i];
+    j.arrival=arrival;
+    j.release=arrival;
+    j.remaining=table.exec[i];
+    if(variation.active() && i<periodicCount){
+        if(!variation.jitter.empty() && variation.jitter[i]>0)j.release+=rng.between(0,variation.jitter[i]);
+        if(!variation.exec.empty())j.remaining=variation.exec[i].draw(table.exec[i],rng);
+    }
+    j.deadline=arrival+table.deadline[i];
+}
+
+// job i is finished with, its fields become the next job's
+template<class P,class S>
+void Simulator<P,S>::renew(int i){
+    EventJob& j=jobs[i];
+    long long gap=table.period[i];
+    if(!variation.sporadic.empty() && i<periodicCount && variation.sporadic[i]>0)
+        gap+=rng.between(0,variation.sporadic[i]);
+    arriveJob(i,j.arrival+gap);
+    j.seq=seqCounter++;
+    j.active=false;
+    j.level=table.priority[i];
+    j.boosted=false;
+    j.preempted=false;
+}
+
+// restores the place of entry i in whichever ready heap holds it
+template<class P,class S>
+void Simulator<P,S>::reorder(int i){
+    if(ready.contains(i))ready.update(i);
+    else if(serverReady.contains(i))serverReady.update(i);
+}
+
+// Equal keys keep their previous relative order. An entry whose key grew was behind
+// everything it now ties with, so it wins those ties; an entry whose key shrank loses them;
+// newly released entries come after every entry that was already active.
+// Only the entry that ran and the servers brought up to date can change key between two decisions.
+template<class P,class S>
+void Simulator<P,S>::updateStamps(const vector<int>& released){
+    vector<int> touched,grew,shrank;
+    if(lastRunning>=0)touched.push_back(lastRunning);
+    for(int k:changed) if(servers[k].entry>=0 && servers[k].entry!=lastRunning)touched.push_back(servers[k].entry);
+    for(int i:touched){
+        if(!jobs[i].active || find(released.begin(),released.end(),i)!=released.end())continue;
+        long long k=P::key(jobs[i]);
+        if(k>jobs[i].key)grew.push_back(i);
+        else if(k<jobs[i].key)shrank.push_back(i);
+    }
+    auto previousOrder=[this](int a,int b){ return before(a,b); };
+    sort(grew.begin(),grew.end(),previousOrder);
+    sort(shrank.begin(),shrank.end(),previousOrder);
+    for(auto it=grew.rbegin();it!=grew.rend();++it)jobs[*it].stamp=--bestStamp;
+    for(int i:shrank)jobs[i].stamp=++worstStamp;
+    vector<int> byseq=released;
+    sort(byseq.begin(),byseq.end(),[this](int a,int b){ return jobs[a].seq<jobs[b].seq; });
+    for(int i:byseq)jobs[i].stamp=++worstStamp;
+    for(int i:grew)jobs[i].key=P::key(jobs[i]);
+    for(int i:shrank)jobs[i].key=P::key(jobs[i]);
+    for(int i:released)jobs[i].key=P::key(jobs[i]);
+    for(int i:grew)reorder(i);
+    for(int i:shrank)reorder(i);
+}
+
+// Everything the decisions from time on depend on, times relative to it. seq and stamp only
+// matter through comparisons and new values always go past the existing ones, so they are kept
+// as ranks. Only called once no aperiodic arrives any more: then a server without backlog never
+// runs again and its deadline and key are left out. Metrics fields (start) are not state.
+template<class P,class S>
+void Simulator<P,S>::captureState(long long time){
+    state.clear();
+    int n=jobs.size();
+    auto idleServer=[this](int i){
+        if(i<periodicCount)return false;
+        const ServerState& s=servers[serverOf[i-periodicCount]];
+        return !polling(s) && !s.aperiodics.hasReady();
+    };
+    for(int i=0;i<n;i++){
+        const EventJob& j=jobs[i];
+        bool server=i>=periodicCount;
+        bool idle=idleServer(i);
+        state.push_back(j.remaining);
+        state.push_back(j.active | j.fresh<<1 | j.late<<2 | j.boosted<<3 | j.preempted<<4
+                        | (ready.contains(i) || serverReady.contains(i))<<5 | releases.contains(i)<<6
+                        | deadlines.contains(i)<<7);
+        if(!server){
+            state.push_back(j.release-time);
+            state.push_back(j.deadline-time);
+            state.push_back(j.level);
+        }else if(constantBandwidth(servers[serverOf[i-periodicCount]]) && !idle)state.push_back(j.deadline-time);
+        if(P::dynamic && !idle)state.push_back(j.key-time);
+    }
+    order.resize(n);
+    for(int i=0;i<n;i++)order[i]=i;
+    sort(order.begin(),order.end(),[this](int a,int b){ return jobs[a].seq<jobs[b].seq; });
+    state.insert(state.end(),order.begin(),order.end());
+    if(P::dynamic){
+        order.clear();
+        for(int i=0;i<n;i++) if(jobs[i].active && !idleServer(i))order.push_back(i);
+        sort(order.begin(),order.end(),[this](int a,int b){ return jobs[a].stamp<jobs[b].stamp; });
+        state.push_back(-1);
+        state.insert(state.end(),order.begin(),order.end());
+    }
+    // an aperiodic last job is named by its place in its server's backlog, -2 once it is finished
+    long long last=lastJob;
+    if(lastKind==SEG_SERVER || lastKind==SEG_APERIODIC){
+        last=-2;
+        for(const auto& s:servers){
+            long long k=0;
+            for(auto a=s.aperiodics.begin();a!=s.aperiodics.end();++a,++k) if(a->id==lastJob)last=k;
+        }
+    }
+    state.insert(state.end(),{(long long)lastRunning,(long long)lastFinished,(long long)lastKind,last,
+                              overheadLeft,regionLeft});
+    for(const auto& s:servers){
+        if(s.entry>=0)state.push_back(time%s.period);
+        if(sporadic(s)){
+            state.push_back(s.activeSince<0?-1:time-s.activeSince);
+            state.push_back(s.consumed);
+            for(size_t k=s.replenishHead;k<s.replenishments.size();k++){
+                state.push_back(s.replenishments[k].first-time);
+                state.push_back(s.replenishments[k].second);
+            }
+        }
+        state.push_back(-1);
+        for(auto a=s.aperiodics.begin();a!=s.aperiodics.end();++a){
+            state.push_back(a->remaining);
+            if(totalBandwidth(s))state.push_back(a->deadline-time);
+        }
+    }
+}
+
+template<class P,class S>
+SimResult Simulator<P,S>::run(){
+    SimResult result;
+    result.modelled=model.active();
+    result.bounded=bounded;
+    if(!warning.empty())sink.warning(warning);
+    sink.begin(names);
+    if(metrics)metrics->begin(names);
+    if(onMiss!=MISS_ABORT){
+        result.overload.resize(periodicCount);
+        for(int i=0;i<periodicCount;i++)result.overload[i].id=names.tasks[i];
+    }
+    if(S::declared){
+        result.classes.resize(servers.size());
+        for(size_t k=0;k<servers.size();k++)result.classes[k].server=servers[k].name;
+    }
+
+    long long time=0,previous=-1;
+    result.steadyStateChecked=steadyState;
+    while(time<end){
+        if(steadyState && anchor>=0 && releases.contains(anchor) && jobs[anchor].release<=time
+           && arrivalsOver(previous)){
+            captureState(time);
+            long long earlier=history.match(time,state);
+            if(earlier>=0){
+                result.cycleStart=earlier;
+                result.cycleLength=time-earlier;
+                break;
+            }
+        }
+        int missed=findMissed(time);
+        if(missed>=0){
+            if(!result.missed){
+                result.missed=true;
+                result.missId=names.tasks[missed];
+                result.missTime=time;
+            }
+            if(onMiss==MISS_ABORT)break;
+            for(;missed>=0;missed=findMissed(time))missDeadline(missed,result);
+        }
+        if(lastRunning>=0)jobs[lastRunning].fresh=false;
+
+        released.clear();
+        while(!releases.empty() && jobs[releases.top()].release<=time){
+            int i=releases.pop();
+            jobs[i].active=true;
+            released.push_back(i);
+        }
+        // the servers with something due, the one that ran and the pollers whose key is stale
+        changed.clear();
+        while(!events.empty() && servers[events.top()].event<=time)visit(events.pop(),time);
+        if(lastRunning>=periodicCount)visit(serverOf[lastRunning-periodicCount],time);
+        if(lastBackground>=0)visit(lastBackground,time);
+        for(int k:polled)visit(k,time);
+        polled.clear();
+        for(int k:changed)replenish(servers[k],time);
+        if(P::dynamic)updateStamps(released);
+        for(int i:released) if(i<periodicCount)ready.push(i);
+        for(int k:changed)
+            if(polling(servers[k]) && time%servers[k].period==0){
+                poll(servers[k]);
+                polled.push_back(k);
+            }
+        for(int k:changed)place(k,time);
+
+        int running=ready.empty()?-1:ready.top();
+        if(!serverReady.empty() && (running<0 || before(serverReady.top(),running)))running=serverReady.top();
+        bool interrupted=lastRunning>=0 && running!=lastRunning && !lastFinished && jobs[lastRunning].active
+                         && (lastRunning<periodicCount || serverReady.contains(lastRunning));
+        if(P::enhanced && interrupted && running>=0){
+            // keys are laxity + time, so their difference is the difference in laxity
+            const EventJob& held=jobs[lastRunning];
+            const EventJob& challenger=jobs[running];
+            if(challenger.key>time && (held.deadline<=challenger.deadline
+                                       || held.key-challenger.key<=model.laxityThreshold)){
+                running=lastRunning;
+                interrupted=false;
+            }
+        }
+        if(interrupted && !model.region.empty() && regionLeft!=0 && lastRunning<periodicCount
+           && model.region[lastRunning]>0){
+            // the running job holds the processor for its region, counted from the first request
+            if(regionLeft<0){
+                regionLeft=model.region[lastRunning];
+                result.deferredPreemptions++;
+            }
+            running=lastRunning;
+            interrupted=false;
+        }
+        if(running!=lastRunning || lastFinished)regionLeft=-1;
+        if(interrupted){
+            result.preemptions++;
+            if(lastRunning<periodicCount){
+                jobs[lastRunning].preempted=true;
+                if(metrics)metrics->tasks[lastRunning].preemptions++;
+            }
+        }
+        if(!model.threshold.empty() && running>=0 && running<periodicCount){
+            EventJob& j=jobs[running];
+            if(!j.boosted){
+                j.boosted=true;
+                j.level=max(j.level,table.priority[model.threshold[running]]); // the server may reorder OPA
+                ready.update(running);
+            }else if(running==lastRunning){
+                // higher priority releases that stay below the threshold do not get in
+                for(int i:released)
+                    if(i<periodicCount && table.priority[i]>table.priority[running])result.avoidedPreemptions++;
+            }
+        }
+        // the idle time goes to the background servers in the order they were declared
+        int idleServer=running<0 && !backgroundReady.empty()?backgroundReady.top():-1;
+        ServerState* server=running>=periodicCount?&servers[serverOf[running-periodicCount]]
+                           :idleServer>=0?&servers[idleServer]:nullptr;
+        if(model.costs()){
+            // a different job pays the switch, a resumed preempted one its cache reload too
+            int kind=SEG_IDLE,job=-1;
+            if(running>=0){
+                kind=running>=periodicCount?SEG_SERVER:SEG_TASK;
+                job=running>=periodicCount?server->aperiodics.front().id:running;
+            }else if(server){
+                kind=SEG_APERIODIC;
+                job=server->aperiodics.front().id;
+            }
+            if(kind==SEG_IDLE)overheadLeft=0;
+            else if(kind!=lastKind || job!=lastJob){
+                overheadLeft=model.switchCost;
+                if(kind==SEG_TASK && jobs[running].preempted && !model.reload.empty())
+                    overheadLeft+=model.reload[running];
+                if(kind==SEG_TASK)jobs[running].preempted=false;
+                if(overheadLeft>0)result.switches++;
+            }
+            lastKind=kind;
+            lastJob=job;
+            if(kind==SEG_SERVER)lastServer=running;
+        }
+
+        // length of the segment until the next instant that can change the decision
+        long long len=end-time;
+        if(!releases.empty())len=min(len,jobs[releases.top()].release-time);
+        if(!deadlines.empty())len=min(len,jobs[deadlines.top()].deadline-time);
+        if(!events.empty())len=min(len,servers[events.top()].event-time);
+        // under LLF a poller's new budget only shows up in the next unit's laxities
+        if(P::laxity && !polled.empty())len=1;
+        if(running>=0){
+            len=min(len,jobs[running].remaining);
+            if(server)len=min(len,server->aperiodics.front().remaining);
+            if(regionLeft>0)len=min(len,regionLeft); // nothing gets in before it ends
+            else if(P::laxity){
+                // a waiting job overtakes once its laxity drops below the running one's
+                // (ELLF: by more than the threshold, or to zero)
+                int challengers[2]={ready.empty()?-1:ready.top()!=running?ready.top():ready.second(),
+                                    serverReady.empty()?-1:serverReady.top()!=running?serverReady.top()
+                                                                                     :serverReady.second()};
+                for(int i:challengers){
+                    if(i<0)continue;
+                    long long overtake=jobs[i].key-jobs[running].key+1;
+                    if(P::enhanced){
+                        if(jobs[running].deadline<=jobs[i].deadline)overtake=LLONG_MAX;
+                        else overtake+=model.laxityThreshold;
+                        overtake=min(overtake,jobs[i].key-time);
+                    }
+                    if(overtake<len)len=overtake;
+                }
+            }
+        }else if(server){
+            len=min(len,server->aperiodics.front().remaining);
+        }
+        if(overheadLeft>0)len=min(len,overheadLeft);
+        if(len<1 || tickByTick)len=1; // zero length jobs never complete, as in a unit by unit loop
+
+        Segment seg;
+        seg.start=time;
+        seg.end=time+len;
+        lastFinished=false;
+        if(overheadLeft>0){
+            // the processor is busy switching: time passes, the job does not progress
+            seg.overhead=true;
+            seg.kind=(SegmentKind)lastKind;
+            seg.job=lastJob;
+            if(lastKind==SEG_SERVER){
+                seg.server=lastServer;
+                seg.budget=jobs[lastServer].remaining;
+            }
+            overheadLeft-=len;
+            result.overhead+=len;
+        }else if(running>=periodicCount){
+            int k=serverOf[running-periodicCount];
+            ServerState& s=*server;
+            EventJob& j=jobs[running];
+            AperiodicJob& a=s.aperiodics.front();
+            seg.kind=SEG_SERVER;
+            seg.job=a.id;
+            seg.server=running;
+            seg.budget=j.remaining;
+            j.remaining-=len;
+            a.remaining-=len;
+            if(a.remaining==0)serve(k,time+len,result);
+            if(sporadic(s)){
+                s.consumed+=len;
+                if(s.activeSince>=0){
+                    // the active period ends with the budget or the pending work
+                    bool pending=s.aperiodics.hasReady() || s.aperiodics.nextRelease()<=time+len;
+                    if(j.remaining==0 || !pending){
+                        if(s.consumed>0)s.replenishments.push_back({s.activeSince+s.period,s.consumed});
+                        s.activeSince=-1;
+                        s.consumed=0;
+                    }
+                }
+            }
+            if(constantBandwidth(s) && j.remaining==0){
+                j.remaining=s.budget;
+                j.deadline+=s.period;
+            }
+        }else if(running>=0){
+            seg.kind=SEG_TASK;
+            seg.job=running;
+            EventJob& j=jobs[running];
+            j.remaining-=len;
+            if(regionLeft>0)regionLeft-=len;
+            if(metrics && j.start<0)j.start=time;
+            if(j.remaining==0){
+                if(metrics){
+                    metrics->completed(running,j.arrival,j.start,time+len,j.deadline);
+                    j.start=-1;
+                }
+                if(j.late)result.overload[running].tardiness.add(time+len-j.deadline);
+                else if(onMiss!=MISS_ABORT)result.overload[running].hit();
+                ready.erase(running);
+                renew(running);
+                j.fresh=true;
+                lastFinished=true;
+                lastKind=SEG_IDLE; // the task's next job is dispatched anew
+                if(regionLeft>=0){
+                    result.avoidedPreemptions++;
+                    regionLeft=-1;
+                }
+                releases.push(running);
+                if(j.late)deadlines.push(running);
+                else deadlines.update(running);
+                j.late=false;
+            }
+        }else if(server){
+            seg.kind=SEG_APERIODIC;
+            AperiodicJob& a=server->aperiodics.front();
+            seg.job=a.id;
+            a.remaining-=len;
+            if(a.remaining==0)serve(idleServer,time+len,result);
+        }else{
+            seg.kind=SEG_IDLE;
+            seg.backlogEmpty=unfinished==0;
+        }
+        sink.segment(seg);
+        if(metrics)metrics->segment(seg);
+        result.segments++;
+        lastRunning=running;
+        lastBackground=idleServer;
+        previous=time;
+        time+=len;
+    }
+    result.simulatedUntil=time;
+    result.aperiodicPending=unfinished;
+    for(size_t k=0;k<result.classes.size();k++)result.classes[k].pending=servers[k].aperiodics.unfinished();
+    return result;
+}
+
+// the server of the command line as the one element of a server vector (none for no server, or
+// for a budgeted type without budget and period)
+vector<DeclaredServer> commandLineServer(const string& serverType,const Server* server){
+    vector<DeclaredServer> servers;
+    if(serverType=="BG")servers.push_back({"",serverType,0,0});
+    else if(budgetedServer(serverType) && server)
+        servers.push_back({server->ID,serverType,server->budget,server->period});
+    return servers;
+}
+
+template<class P>
+SimResult simulateWith(const vector<Task>& tasks,ArrivalSource& arrivals,const string& serverType,
+                       const Server* server,TraceSink& sink,bool tickByTick,
+                       RunMetrics* metrics=nullptr,MissPolicy onMiss=MISS_ABORT,
+                       const PreemptionModel* model=nullptr,long long horizon=0,bool steadyState=false,
+                       const JobVariation* variation=nullptr,const vector<DeclaredServer>* declared=nullptr){
+    if(declared && !declared->empty())
+        return Simulator<P,DeclaredServers>(tasks,arrivals,*declared,sink,tickByTick,metrics,onMiss,model,horizon,steadyState,variation).run();
+    vector<DeclaredServer> servers=commandLineServer(serverType,server);
+    if(serverType=="BG")return Simulator<P,BackgroundServer>(tasks,arrivals,servers,sink,tickByTick,metrics,onMiss,model,horizon,steadyState,variation).run();
+    if(serverType=="POLLER")return Simulator<P,PollingServer>(tasks,arrivals,servers,sink,tickByTick,metrics,onMiss,model,horizon,steadyState,variation).run();
+    if(serverType=="DS")return Simulator<P,DeferrableServer>(tasks,arrivals,servers,sink,tickByTick,metrics,onMiss,model,horizon,steadyState,variation).run();
+    if(serverType=="SS")return Simulator<P,SporadicServer>(tasks,arrivals,servers,sink,tickByTick,metrics,onMiss,model,horizon,steadyState,variation).run();
+    if(serverType=="TBS")return Simulator<P,TotalBandwidthServer>(tasks,arrivals,servers,sink,tickByTick,metrics,onMiss,model,horizon,steadyState,variation).run();
+    if(serverType=="CBS")return Simulator<P,ConstantBandwidthServer>(tasks,arrivals,servers,sink,tickByTick,metrics,onMiss,model,horizon,steadyState,variation).run();
+    return Simulator<P,NoServer>(tasks,arrivals,servers,sink,tickByTick,metrics,onMiss,model,horizon,steadyState,variation).run();
+}
+
+// picks the Simulator instantiation for a runtime algorithm code and server type; declared
+// servers (the S lines of the input), when given, take the place of the server
+SimResult simulate(const vector<Task>& tasks,ArrivalSource& arrivals,int choose,const string& serverType,
+                   const Server* server,TraceSink& sink,bool tickByTick,RunMetrics* metrics=nullptr,
+                   MissPolicy onMiss=MISS_ABORT,const PreemptionModel* model=nullptr,long long horizon=0,
+                   bool steadyState=false,const JobVariation* variation=nullptr,
+                   const vector<DeclaredServer>* declared=nullptr){
+    //1 for rm 2 for dm 3 for edf 4 for llf 5 for opa 6 for ellf
+    if(choose==1)return simulateWith<RateMonotonic>(tasks,arrivals,serverType,server,sink,tickByTick,metrics,onMiss,model,horizon,steadyState,variation,declared);
+    if(choose==2)return simulateWith<DeadlineMonotonic>(tasks,arrivals,serverType,server,sink,tickByTick,metrics,onMiss,model,horizon,steadyState,variation,declared);
+    if(choose==5)return simulateWith<AudsleyOptimal>(tasks,arrivals,serverType,server,sink,tickByTick,metrics,onMiss,model,horizon,steadyState,variation,declared);
+    if(choose==6)return simulateWith<EnhancedLeastLaxityFirst>(tasks,arrivals,serverType,server,sink,tickByTick,metrics,onMiss,model,horizon,steadyState,variation,declared);
+    if(choose==3)return simulateWith<EarliestDeadlineFirst>(tasks,arrivals,serverType,server,sink,tickByTick,metrics,onMiss,model,horizon,steadyState,variation,declared);
+    return simulateWith<LeastLaxityFirst>(tasks,arrivals,serverType,server,sink,tickByTick,metrics,onMiss,model,horizon,steadyState,variation,declared);
+}
+
+SimResult simulate(const vector<Task>& tasks,const vector<Task>& aperiodicTasks,int choose,const string& serverType,
+                   const Server* server,TraceSink& sink,bool tickByTick,RunMetrics* metrics=nullptr,
+                   MissPolicy onMiss=MISS_ABORT,const PreemptionModel* model=nullptr,long long horizon=0,
+                   bool steadyState=false,const JobVariation* variation=nullptr,
+                   const vector<DeclaredServer>* declared=nullptr){
+    VectorArrivals arrivals(aperiodicTasks);
+    return simulate(tasks,arrivals,choose,serverType,server,sink,tickByTick,metrics,onMiss,model,horizon,steadyState,
+                    variation,declared);
+}
+
+// ---------------- declared servers ----------------
+// Any number of servers declared in the input file ("S name type budget period"), each serving its
+// own class of aperiodics (the A lines tagged with its name), run by the Simulator above as it runs
+// the single server of the command line.
+
+// false with a message when a tag names no server or a server does not go with the algorithm
+// (untagged aperiodics go to the first server)
+bool serverClasses(const vector<Task>& aperiodic,const vector<DeclaredServer>& servers,int choose,string& error){
+    for(const auto& s:servers){
+        if(const char* mismatch=serverMismatch(choose,s.type)){
+            error=s.name+": "+mismatch;
+            return false;
+        }
+    }
+    for(const auto& a:aperiodic){
+        if(a.tag.empty())continue;
+        size_t k=0;
+        while(k<servers.size() && servers[k].name!=a.tag)k++;
+        if(k==servers.size()){
+            error=a.id+" is tagged "+a.tag+", which no S line declares.";
+            return false;
+        }
+    }
+    return true;
+}
+
+// the periodic tasks with every budgeted server as the task of its budget and period
+vector<Task> withServerTasks(const vector<Task>& tasks,const vector<DeclaredServer>& servers){
+    vector<Task> all=tasks;
+    for(const auto& s:servers)
+        if(budgetedServer(s.type))all.push_back(Task(s.name,0,s.budget,s.period,s.period));
+    return all;
+}
+
+// ---------------- schedulability analysis ----------------
+// Decides feasibility without simulating. A positive verdict always holds; a negative one is
+// final only when the test is exact for the task set, otherwise the simulation decides.
+
+struct TaskVerdict{
+    string id;
+    long long responseTime;  // worst case, -1 when it grows without bound
+    long long deadline;
+};
+
+struct AnalysisResult{
+    bool schedulable=false;
+    bool exact=false;        // a negative verdict is final as well
+    string method;
+    vector<TaskVerdict> tasks;
+    long long overloadAt=-1;     // processor demand test: a deadline whose demand exceeds it
+    long long overloadDemand=0;
+};
+
+// worst case response time of set[i] under the interference of hp, over the whole level-i busy
+// period so that deadlines longer than the period are covered; -1 if it does not converge
+long long responseTime(const vector<Task>& set,const vector<long long>& jitter,const vector<int>& hp,int i){
+    const Task& t=set[i];
+    double u=(double)t.exec_time/t.period;
+    for(int j:hp)u+=(double)set[j].exec_time/set[j].period;
+    if(u>1+1e-12)return -1;
+
+    // without jitter a level-i busy period ends within the hyperperiod of the tasks involved;
+    // one still open after that plus the largest jitter never ends
+    const long long cap=LLONG_MAX/4;
+    long long limit=t.period;
+    long long maxJitter=jitter[i];
+    for(int j:hp){
+        long long a=limit,b=set[j].period;
+        while(b){ a%=b; swap(a,b); }
+        if(limit<cap)limit=limit/a>cap/set[j].period?cap:limit/a*set[j].period;
+        maxJitter=max(maxJitter,jitter[j]);
+    }
+    limit=min(cap,limit+maxJitter);
+    long long worst=0;
+    long long w=0;
+    for(long long q=0;;q++){
+        w=max(w,(q+1)*t.exec_time);
+        while(true){
+            long long next=(q+1)*t.exec_time;
+            for(int j:hp)next+=((w+jitter[j]+set[j].period-1)/set[j].period)*set[j].exec_time;
+            if(next==w)break;
+            if(next>limit)return -1;
+            w=next;
+        }
+        if(w>limit)return -1;
+        worst=max(worst,w-q*t.period);
+        if(w<=(q+1)*t.period)break;
+    }
+    return worst;
+}
+
+// Audsley: from the lowest level up, the level goes to a task that meets its deadline with every
+// task still unassigned above it (the DM-lowest such task, so DM's order comes out when it works).
+// Optimal for the response time test; DM levels and found=false when no order passes it.
+vector<int> optimalPriorityLevels(const vector<Task>& set,const vector<long long>& jitter,bool* found){
+    vector<int> dm=DeadlineMonotonic::levels(set,jitter);
+    vector<int> candidates(set.size());
+    for(size_t i=0;i<set.size();i++)candidates[dm[i]]=i; // lowest DM level first
+    vector<int> level(set.size(),-1);
+    for(size_t lv=0;lv<set.size();lv++){
+        int pick=-1;
+        for(int i:candidates){
+            if(level[i]>=0)continue;
+            vector<int> hp;
+            for(int j:candidates) if(j!=i && level[j]<0)hp.push_back(j);
+            long long r=responseTime(set,jitter,hp,i);
+            if(r>=0 && r<=set[i].deadline_relative){
+                pick=i;
+                break;
+            }
+        }
+        if(pick<0){
+            if(found)*found=false;
+            return dm;
+        }
+        level[pick]=lv;
+    }
+    if(found)*found=true;
+    return level;
+}
+
+vector<int> priorityLevels(const vector<Task>& set,const vector<long long>& jitter,int choose){
+    if(choose==1)return RateMonotonic::levels(set,jitter);
+    if(choose==5)return AudsleyOptimal::levels(set,jitter);
+    return DeadlineMonotonic::levels(set,jitter);
+}
+
+// response time analysis for RM/DM/OPA, the server counted as one more periodic task
+// (a deferrable server with release jitter period-budget for its back to back execution,
+// a sporadic server exactly like a periodic task)
+AnalysisResult fixedPriorityAnalysis(const vector<Task>& tasks,int choose,const string& serverType,const Server* server){
+    AnalysisResult a;
+    vector<Task> set=tasks;
+    vector<long long> jitter(set.size(),0);
+    bool synchronous=true;
+    for(const auto& t:tasks) if(t.release_time!=0)synchronous=false;
+    if(server && budgetedServer(serverType)){
+        set.push_back(Task(server->ID,0,server->budget,server->period,server->period));
+        jitter.push_back(serverType=="DS"?server->period-server->budget:0);
+    }
+    vector<int> levels=priorityLevels(set,jitter,choose);
+    for(size_t i=0;i<set.size();i++)set[i].priority=levels[i];
+
+    // hyperbolic bound: prod(U_i+1)<=2 suffices for implicit deadlines under RM
+    bool implicit=serverType!="DS";
+    for(const auto& t:set) if(t.deadline_relative!=t.period)implicit=false;
+    if(implicit){
+        double product=1;
+        for(const auto& t:set)product*=1+(double)t.exec_time/t.period;
+        if(product<=2){
+            a.schedulable=true;
+            a.exact=true;
+            a.method="hyperbolic bound";
+            return a;
+        }
+    }
+
+    // exact for synchronous periodic sets; the server's load depends on the aperiodic
+    // arrivals so with a server it is only sufficient
+    a.method=choose==5?"response time analysis, Audsley priority order":"response time analysis";
+    a.exact=synchronous && set.size()==tasks.size();
+    a.schedulable=true;
+    for(size_t i=0;i<tasks.size();i++){
+        vector<int> hp;
+        for(size_t j=0;j<set.size();j++)
+            if(j!=i && set[j].priority>set[i].priority)hp.push_back(j);
+        long long r=responseTime(set,jitter,hp,i);
+        a.tasks.push_back({set[i].id,r,set[i].deadline_relative});
+        if(r<0 || r>set[i].deadline_relative)a.schedulable=false;
+    }
+    return a;
+}
+
+// EDF processor demand of the synchronous set in [0,t]: every job with release and deadline inside it
+long long demand(const vector<Task>& tasks,long long t){
+    long long h=0;
+    for(const auto& k:tasks)
+        if(t>=k.deadline_relative)h+=((t-k.deadline_relative)/k.period+1)*k.exec_time;
+    return h;
+}
+
+// latest absolute deadline strictly before t, -1 if there is none
+long long deadlineBefore(const vector<Task>& tasks,long long t){
+    long long d=-1;
+    for(const auto& k:tasks)
+        if(t>k.deadline_relative)d=max(d,(t-1-k.deadline_relative)/k.period*k.period+k.deadline_relative);
+    return d;
+}
+
+// EDF/LLF: U<=1 is exact when no deadline is shorter than its period, otherwise Quick
+// Processor-demand Analysis (Zhang & Burns) walks back from the end of the busy period
+// and only visits the deadlines where the demand could exceed the time available
+AnalysisResult dynamicPriorityAnalysis(const vector<Task>& tasks){
+    AnalysisResult a;
+    a.method="utilisation bound";
+    a.schedulable=true;
+    a.exact=true;
+    double u=0;
+    for(const auto& t:tasks)u+=(double)t.exec_time/t.period;
+    if(u>1+1e-12){
+        a.schedulable=false;
+        return a;
+    }
+    bool constrained=false;
+    for(const auto& t:tasks) if(t.deadline_relative<t.period)constrained=true;
+    if(!constrained || tasks.empty())return a;
+
+    // the synchronous release is the worst case, so with offsets only a positive verdict holds
+    a.method="processor demand (QPA)";
+    for(const auto& t:tasks) if(t.release_time!=0)a.exact=false;
+
+    // L: the synchronous busy period, or the tighter closed form when U<1
+    long long busy=0;
+    for(const auto& t:tasks)busy+=t.exec_time;
+    while(true){
+        long long next=0;
+        for(const auto& t:tasks)next+=(busy+t.period-1)/t.period*t.exec_time;
+        if(next==busy)break;
+        busy=next;
+    }
+    long long limit=busy;
+    if(u<1-1e-12){
+        double la=0;
+        long long dMinusT=0;
+        for(const auto& t:tasks){
+            la+=(double)(t.period-t.deadline_relative)*t.exec_time/t.period;
+            dMinusT=max(dMinusT,t.deadline_relative-t.period);
+        }
+        la=max<double>(la/(1-u),dMinusT);
+        if(la<limit)limit=(long long)ceil(la);
+    }
+
+    long long dMin=tasks[0].deadline_relative;
+    for(const auto& t:tasks)dMin=min(dMin,t.deadline_relative);
+    long long t=deadlineBefore(tasks,limit+1);
+    long long h=t<0?0:demand(tasks,t);
+    while(h<=t && h>dMin){
+        t=h<t?h:deadlineBefore(tasks,t);
+        h=demand(tasks,t);
+    }
+    a.schedulable=h<=dMin;
+    if(!a.schedulable){
+        a.overloadAt=t;
+        a.overloadDemand=h;
+    }
+    return a;
+}
+
+// false when there is no test for the configuration
+bool analyse(const vector<Task>& tasks,int choose,const string& serverType,const Server* server,AnalysisResult& a){
+    if(fixedPriority(choose)){
+        a=fixedPriorityAnalysis(tasks,choose,serverType,server);
+        return true;
+    }
+    if(choose==6)return false; // holding the running job gives up LLF's optimality, no test known
+    // a bandwidth server never demands more than a periodic task of its budget and period
+    if(server && (serverType=="TBS" || serverType=="CBS")){
+        vector<Task> set=tasks;
+        set.push_back(Task(server->ID,0,server->budget,server->period,server->period));
+        a=dynamicPriorityAnalysis(set);
+        a.exact=false;
+        return true;
+    }
+    // the EDF/LLF polling and deferrable servers keep deadlines the analysis does not model
+    if(budgetedServer(serverType))return false;
+    a=dynamicPriorityAnalysis(tasks);
+    return true;
+}
+
+void printAnalysis(const AnalysisResult& a,bool detailed){
+    if(detailed){
+        for(const auto& t:a.tasks){
+            cout<<t.id<<": worst case response time ";
+            if(t.responseTime<0)cout<<"unbounded";
+            else cout<<t.responseTime;
+            cout<<", deadline "<<t.deadline<<"\n";
+        }
+        if(a.overloadAt>=0)
+            cout<<"Processor demand "<<a.overloadDemand<<" exceeds the "<<a.overloadAt<<" time units up to that deadline\n";
+    }
+    cout<<"Analysis ("<<a.method<<"): ";
+    if(a.schedulable)cout<<"schedulable\n";
+    else if(a.exact)cout<<"not schedulable\n";
+    else cout<<"not proven schedulable\n";
+}
+
+// the order OPA runs the tasks in, highest priority first, as the simulator assigns it
+void printPriorityOrder(const vector<Task>& tasks,const string& serverType,const Server* server){
+    vector<Task> set=tasks;
+    vector<long long> jitter(set.size(),0);
+    if(server && budgetedServer(serverType)){
+        set.push_back(Task(server->ID,0,server->budget,server->period,server->period));
+        jitter.push_back(serverType=="DS"?server->period-server->budget:0);
+    }
+    bool found;
+    vector<int> levels=optimalPriorityLevels(set,jitter,&found);
+    vector<int> order(set.size());
+    for(size_t i=0;i<set.size();i++)order[set.size()-1-levels[i]]=i;
+    if(!found)cout<<"No priority order meets every deadline, deadline monotonic order used.\n";
+    cout<<"Priority order:";
+    for(int i:order)cout<<" "<<set[i].id;
+    cout<<"\n";
+}
+
+// ---------------- limited preemption ----------------
+// The largest non-preemptive regions and preemption thresholds the analysis still accepts,
+// for the periodic tasks on their own (a server is not accounted for). Fewer preemptions are
+// fewer context switches and cache reloads.
+
+vector<int> fixedPriorities(const vector<Task>& tasks,int choose){
+    return priorityLevels(tasks,vector<long long>(tasks.size(),0),choose);
+}
+
+// most blocking task i tolerates under fixed priorities: max over t of t - (C_i + higher priority demand in
+// [0,t)), t up to the first deadline (Bini & Buttazzo); -1 if it misses without any blocking
+long long blockingTolerance(const vector<Task>& tasks,const vector<int>& prio,int i){
+    long long horizon=min(tasks[i].deadline_relative,tasks[i].period);
+    vector<long long> points{horizon};
+    for(size_t j=0;j<tasks.size();j++){
+        if((int)j==i || prio[j]<prio[i])continue;
+        for(long long t=tasks[j].period;t<horizon;t+=tasks[j].period)points.push_back(t);
+    }
+    long long best=-1;
+    for(long long t:points){
+        long long w=tasks[i].exec_time;
+        for(size_t j=0;j<tasks.size();j++)
+            if((int)j!=i && prio[j]>=prio[i])w+=(t+tasks[j].period-1)/tasks[j].period*tasks[j].exec_time;
+        best=max(best,t-w);
+    }
+    return best;
+}
+
+// floating region lengths: a region of task k delays every job that may preempt it, so under
+// fixed priorities it is bounded by their blocking tolerance, under EDF by the slack t - demand(t) at every
+// deadline t before D_k (Baruah); empty when the set fails fully preemptive
+vector<long long> largestRegions(const vector<Task>& tasks,int choose){
+    vector<long long> region;
+    for(const auto& t:tasks)region.push_back(t.exec_time);
+    if(fixedPriority(choose)){
+        vector<int> prio=fixedPriorities(tasks,choose);
+        for(size_t i=0;i<tasks.size();i++){
+            long long beta=blockingTolerance(tasks,prio,i);
+            if(beta<0)return {};
+            for(size_t k=0;k<tasks.size();k++)
+                if(prio[k]<prio[i])region[k]=min(region[k],beta);
+        }
+        return region;
+    }
+    double u=0;
+    long long longest=0;
+    for(const auto& t:tasks){
+        u+=(double)t.exec_time/t.period;
+        longest=max(longest,t.deadline_relative);
+    }
+    if(u>1+1e-12)return {};
+    for(long long t=deadlineBefore(tasks,longest);t>=0;t=deadlineBefore(tasks,t)){
+        long long slack=t-demand(tasks,t);
+        if(slack<0)return {};
+        for(size_t k=0;k<tasks.size();k++)
+            if(t<tasks[k].deadline_relative)region[k]=min(region[k],slack);
+    }
+    return region;
+}
+
+// worst case response time of task i with preemption thresholds (Wang & Saksena): blocked by one
+// lower priority job whose threshold reaches it, delayed by every job of priority >= its own up to
+// its start, afterwards only by those above its threshold; -1 if the busy period does not end
+long long thresholdResponseTime(const vector<Task>& tasks,const vector<int>& prio,const vector<int>& thr,int i){
+    const Task& t=tasks[i];
+    long long block=0;
+    double u=0;
+    for(size_t j=0;j<tasks.size();j++){
+        if(prio[j]<prio[i] && thr[j]>=prio[i])block=max(block,tasks[j].exec_time);
+        if(prio[j]>=prio[i])u+=(double)tasks[j].exec_time/tasks[j].period;
+    }
+    if(u>1+1e-12)return -1;
+    const long long cap=LLONG_MAX/4;
+    long long busy=block+t.exec_time;
+    while(true){
+        long long next=block;
+        for(size_t j=0;j<tasks.size();j++)
+            if(prio[j]>=prio[i])next+=(busy+tasks[j].period-1)/tasks[j].period*tasks[j].exec_time;
+        if(next==busy)break;
+        if(next>cap)return -1;
+        busy=next;
+    }
+    long long worst=0;
+    for(long long q=0;q*t.period<busy;q++){
+        long long start=block+q*t.exec_time;
+        while(true){
+            long long next=block+q*t.exec_time;
+            for(size_t j=0;j<tasks.size();j++)
+                if((int)j!=i && prio[j]>=prio[i])next+=(start/tasks[j].period+1)*tasks[j].exec_time;
+            if(next==start)break;
+            if(next>busy)return -1;
+            start=next;
+        }
+        long long finish=start+t.exec_time;
+        while(true){
+            long long next=start+t.exec_time;
+            for(size_t j=0;j<tasks.size();j++)
+                if(prio[j]>thr[i])next+=((finish+tasks[j].period-1)/tasks[j].period-start/tasks[j].period-1)
+                                        *tasks[j].exec_time;
+            if(next==finish)break;
+            if(next>busy)return -1;
+            finish=next;
+        }
+        worst=max(worst,finish-q*t.period);
+    }
+    return worst;
+}
+
+bool thresholdsSchedulable(const vector<Task>& tasks,const vector<int>& prio,const vector<int>& thr){
+    for(size_t i=0;i<tasks.size();i++){
+        long long r=thresholdResponseTime(tasks,prio,thr,i);
+        if(r<0 || r>tasks[i].deadline_relative)return false;
+    }
+    return true;
+}
+
+// thresholds raised one priority level at a time, highest priority task first, as long as the
+// set stays schedulable; by task whose level is the threshold, empty when it fails fully preemptive
+vector<int> largestThresholds(const vector<Task>& tasks,int choose){
+    vector<int> prio=fixedPriorities(tasks,choose);
+    vector<int> thr=prio;
+    if(!thresholdsSchedulable(tasks,prio,thr))return {};
+    int n=tasks.size();
+    vector<int> owner(n);
+    for(int i=0;i<n;i++)owner[prio[i]]=i;
+    for(int level=n-1;level>=0;level--){
+        int i=owner[level];
+        while(thr[i]<n-1){
+            thr[i]++;
+            if(!thresholdsSchedulable(tasks,prio,thr)){
+                thr[i]--;
+                break;
+            }
+        }
+    }
+    for(int i=0;i<n;i++)thr[i]=owner[thr[i]];
+    return thr;
+}
+
+struct RunOptions{
+    bool tickByTick=false;  // reference: stop after every time unit
+    int benchRuns=0;        // time the simulation this many times instead of printing it
+    bool analyzeOnly=false; // stop after the schedulability analysis
+    string trace="text";    // text (per unit lines), csv or bin (run length intervals)
+    string out;             // trace file, stdout when empty
+    int cores=1;            // processors; above one the task set is scheduled globally or partitioned
+    string partition;       // "" global, ff first fit decreasing, wfd worst fit decreasing
+    bool batch=false;       // input is a directory or multi-set file, algorithm and server are lists
+    bool sensitivity=false; // critical scaling factors instead of a run, input and lists as in batch mode
+    string sweep;           // PMIN:PMAX[:PSTEP[:BSTEP]] server grid instead of a run, lists as in batch mode
+    int threads=0;          // batch worker threads, 0 for one per core
+    string input;           // task file, the benchmark times parsing it
+    string metrics;         // "" off, "-" JSON on stdout after the run, otherwise a JSON file
+    MissPolicy onMiss=MISS_ABORT; // with skip or continue overloaded task sets are simulated too
+    long long switchCost=0; // time units of every context switch
+    string crpd;            // cache reload after a preemption: one value for every task, or a,b,c by task
+    string npr;             // non-preemptive regions: auto, one length for every task, or a,b,c by task
+    bool thresholds=false;  // fixed priority preemption thresholds, the largest the analysis accepts
+    long long laxityThreshold=0; // ELLF: laxity margin a waiting job needs to preempt a later deadline
+    long long horizon=0;    // simulate at most this many time units, 0 for the whole hyperperiod
+    bool steadyState=false; // stop at the first release whose scheduler state was seen before
+    string exec;            // execution time distributions: one for every task, or a,b,c by task
+    string sporadic;        // largest extra inter-arrival gap: N for every task, or a,b,c by task
+    string jitter;          // largest release jitter: N for every task, or a,b,c by task
+    unsigned long long seed=1; // of the first (or only) run with random jobs
+    int monteCarlo=0;       // runs with seeds seed, seed+1, ... instead of one printed run
+    bool randomJobs() const { return !exec.empty() || !sporadic.empty() || !jitter.empty(); }
+    bool limitsPreemption() const { return switchCost>0 || !crpd.empty() || !npr.empty() || thresholds; }
+};
+
+// "N" for every task or "a,b,c" in task order (missing tasks 0); false on anything else
+bool parsePerTask(const string& text,size_t count,vector<long long>& values){
+    values.assign(count,0);
+    stringstream ss(text);
+    string item;
+    size_t i=0;
+    bool single=text.find(',')==string::npos;
+    while(getline(ss,item,',')){
+        char* end;
+        errno=0;
+        long long v=strtoll(item.c_str(),&end,10);
+        if(item.empty() || *end || v<0 || errno==ERANGE)return false;
+        if(single)fill(values.begin(),values.end(),v);
+        else if(i<count)values[i]=v;
+        i++;
+    }
+    return i>0;
+}
+
+// the PreemptionModel of the options for one task set; false with a message for what does not apply.
+// A set that fails fully preemptive gets no automatic regions or thresholds, note says so.
+bool preemptionModel(const vector<Task>& tasks,int choose,const RunOptions& opts,PreemptionModel& model,
+                     string& error,string& note){
+    model=PreemptionModel();
+    model.switchCost=opts.switchCost;
+    model.laxityThreshold=opts.laxityThreshold;
+    if(!opts.crpd.empty() && !parsePerTask(opts.crpd,tasks.size(),model.reload)){
+        error="Wrong --crpd (N or N1,N2,... in task order).";
+        return false;
+    }
+    if(opts.npr=="auto"){
+        if(choose==4 || choose==6){
+            error="--npr=auto needs RM, DM or EDF.";
+            return false;
+        }
+        model.region=largestRegions(tasks,choose);
+        if(model.region.empty())note="No non-preemptive regions: the task set is not schedulable fully preemptive.";
+    }else if(!opts.npr.empty() && !parsePerTask(opts.npr,tasks.size(),model.region)){
+        error="Wrong --npr (auto, Q or Q1,Q2,... in task order).";
+        return false;
+    }
+    if(opts.thresholds){
+        if(!fixedPriority(choose)){
+            error="Preemption thresholds need RM, DM or OPA.";
+            return false;
+        }
+        model.threshold=largestThresholds(tasks,choose);
+        if(model.threshold.empty())note="No preemption thresholds: the task set is not schedulable fully preemptive.";
+    }
+    return true;
+}
+
+// wcet, uniform:LO[:HI] or normal:MEAN:SD, in percent of the WCET
+bool parseExecDistribution(const string& text,ExecDistribution& d){
+    stringstream ss(text);
+    string kind;
+    getline(ss,kind,':');
+    vector<double> v;
+    for(string part;getline(ss,part,':');){
+        char* end;
+        double x=strtod(part.c_str(),&end);
+        if(part.empty() || *end || x<0)return false;
+        v.push_back(x);
+    }
+    d=ExecDistribution();
+    if(kind=="wcet")return v.empty();
+    if(kind=="uniform" && (v.size()==1 || v.size()==2)){
+        d.kind=ExecDistribution::UNIFORM;
+        d.a=v[0];
+        d.b=v.size()==2?v[1]:100;
+        return d.a<=d.b;
+    }
+    if(kind=="normal" && v.size()==2){
+        d.kind=ExecDistribution::NORMAL;
+        d.a=v[0];
+        d.b=v[1];
+        return true;
+    }
+    return false;
+}
+
+// the JobVariation of the options for one task set, seeded with seed; false with a message
+bool jobVariation(const vector<Task>& tasks,const RunOptions& opts,unsigned long long seed,JobVariation& v,
+                  string& error){
+    v=JobVariation();
+    v.seed=seed;
+    if(!opts.exec.empty()){
+        vector<string> items;
+        stringstream ss(opts.exec);
+        for(string item;getline(ss,item,',');)items.push_back(item);
+        v.exec.assign(tasks.size(),ExecDistribution());
+        for(size_t i=0;i<items.size();i++){
+            ExecDistribution d;
+            if(!parseExecDistribution(items[i],d)){
+                error="Wrong --exec (wcet, uniform:LO[:HI] or normal:MEAN:SD in percent of the WCET, one or one per task).";
+                return false;
+            }
+            if(items.size()==1)fill(v.exec.begin(),v.exec.end(),d);
+            else if(i<tasks.size())v.exec[i]=d;
+        }
+    }
+    if(!opts.sporadic.empty() && !parsePerTask(opts.sporadic,tasks.size(),v.sporadic)){
+        error="Wrong --sporadic (N or N1,N2,... in task order).";
+        return false;
+    }
+    if(!opts.jitter.empty() && !parsePerTask(opts.jitter,tasks.size(),v.jitter)){
+        error="Wrong --jitter (N or N1,N2,... in task order).";
+        return false;
+    }
+    return true;
+}
+
+// regions and thresholds as chosen, thresholds named after the task at their level
+void printPreemptionModel(const vector<Task>& tasks,const PreemptionModel& model){
+    if(!model.region.empty()){
+        cout<<"Non-preemptive regions:";
+        for(size_t i=0;i<tasks.size();i++)cout<<" "<<tasks[i].id<<" "<<model.region[i];
+        cout<<"\n";
+    }
+    if(!model.threshold.empty()){
+        cout<<"Preemption thresholds:";
+        for(size_t i=0;i<tasks.size();i++)cout<<" "<<tasks[i].id<<" "<<tasks[model.threshold[i]].id;
+        cout<<"\n";
+    }
+}
+
+void printPreemptionCounts(const SimResult& r,const PreemptionModel& model){
+    cout<<"Preemptions: "<<r.preemptions;
+    if(!model.region.empty())cout<<", "<<r.deferredPreemptions<<" deferred by non-preemptive regions";
+    if(!model.region.empty() || !model.threshold.empty())cout<<", "<<r.avoidedPreemptions<<" avoided";
+    cout<<"\n";
+    if(r.switches || r.overhead){
+        cout<<"Context switch overhead: "<<r.overhead<<" time units in "<<r.switches<<" switches";
+        if(r.simulatedUntil)cout<<" ("<<fixed<<setprecision(2)<<100.0*r.overhead/r.simulatedUntil<<"%)"<<defaultfloat;
+        cout<<"\n";
+    }
+}
+
+// ELLF's context switches and preemptions next to plain LLF's (llf) on the same input and preemption model
+void printLaxityComparison(const PreemptionModel& model,const RunMetrics& metrics,const SimResult& r,
+                           const RunMetrics& llfMetrics,const SimResult& llf){
+    cout<<"Laxity threshold: "<<model.laxityThreshold<<"\n";
+    cout<<"Context switches: "<<metrics.contextSwitches<<" (LLF "<<llfMetrics.contextSwitches;
+    if(llfMetrics.contextSwitches)
+        cout<<", "<<fixed<<setprecision(2)<<showpos
+            <<100.0*(metrics.contextSwitches-llfMetrics.contextSwitches)/llfMetrics.contextSwitches<<"%"
+            <<noshowpos<<defaultfloat;
+    cout<<"), preemptions: "<<r.preemptions<<" (LLF "<<llf.preemptions<<")\n";
+    if(llf.missed!=r.missed || llf.simulatedUntil!=r.simulatedUntil){
+        if(llf.missed)cout<<"LLF misses "<<llf.missId<<" at "<<llf.missTime<<", counts cover different spans.\n";
+        else cout<<"LLF meets every deadline, counts cover different spans.\n";
+    }
+}
+
+// simulated time units per second when stopping at every unit and when jumping between events
+void benchmark(const vector<Task>& tasks,ArrivalSource& aperiodicTasks,int choose,const string& serverType,
+               const Server* server,int runs,const string& input,long long horizon,
+               const vector<DeclaredServer>* declared=nullptr){
+    if(!input.empty()){
+        // map and scan the whole file the way readInputFile does
+        size_t bytes=0;
+        auto begin=chrono::steady_clock::now();
+        for(int i=0;i<runs;i++){
+            MappedFile file(input);
+            vector<Task> periodic;
+            vector<DeclaredServer> servers;
+            size_t count;
+            bool ordered;
+            ostringstream ignored;
+            scanInput(file,periodic,servers,count,ordered,ignored);
+            bytes+=file.size();
+        }
+        double seconds=chrono::duration<double>(chrono::steady_clock::now()-begin).count();
+        cout<<"input parse  : "<<bytes/1e6/max(seconds,1e-9)<<" MB/s ("<<bytes/runs<<" bytes)\n";
+    }
+    NullTrace sink;
+    double tickRate=0;
+    simulate(tasks,aperiodicTasks,choose,serverType,server,sink,false,nullptr,MISS_ABORT,nullptr,horizon,false,nullptr,
+             declared); // warm up, shows warnings once
+    streambuf* errBuf=cerr.rdbuf(nullptr);
+    for(int tickByTick=1;tickByTick>=0;tickByTick--){
+        SimResult r;
+        auto begin=chrono::steady_clock::now();
+        for(int i=0;i<runs;i++)
+            r=simulate(tasks,aperiodicTasks,choose,serverType,server,sink,tickByTick,nullptr,MISS_ABORT,nullptr,horizon,
+                       false,nullptr,declared);
+        double seconds=chrono::duration<double>(chrono::steady_clock::now()-begin).count();
+        double rate=(double)r.simulatedUntil*runs/max(seconds,1e-9);
+        if(tickByTick){
+            tickRate=rate;
+            cout<<"Benchmark: "<<runs<<" runs of "<<r.simulatedUntil<<" time units\n";
+            cout<<"tick by tick : "<<rate<<" time units/s\n";
+        }else{
+            cout<<"event driven : "<<rate<<" time units/s, "<<(double)r.segments*runs/max(seconds,1e-9)
+                <<" decisions/s ("<<rate/tickRate<<"x)\n";
+        }
+    }
+    cerr.rdbuf(errBuf);
+    cerr.clear();
+}
+
+// without --horizon a run covers the whole hyperperiod, which has to fit in 64-bit time
+bool hyperperiodFits(const vector<Task>& tasks,const Server* server){
+    vector<Task> all=tasks;
+    if(server)all.push_back(Task(server->ID,0,server->budget,server->period,server->period));
+    string ignored;
+    return simulationEnd(all,&ignored)>=0;
+}
+
+void printOutcome(const SimResult& r){
+    if(r.missed)cout<<"Deadline missed for "<< r.missId<<" at " <<r.missTime <<". Algorithm is failed.\n";
+    else if(r.cycleLength>0)cout<<"Successfully scheduled until the steady state at "<<r.simulatedUntil<<".\n";
+    else if(r.bounded)cout<<"Successfully scheduled until the horizon "<<r.simulatedUntil<<".\n";
+    else cout<<"Successfully scheduled until hyperperiod.\n";
+}
+
+// --steady-state: where the schedule became periodic, or how far the run got without it
+void printSteadyState(const SimResult& r){
+    if(!r.steadyStateChecked)return;
+    if(r.cycleLength>0)
+        cout<<"Steady state: the state at "<<r.cycleStart<<" came back at "<<r.simulatedUntil
+            <<", the schedule repeats every "<<r.cycleLength<<" time units from "<<r.cycleStart<<".\n";
+    else cout<<"Steady state: no state repeated before "<<r.simulatedUntil<<".\n";
+}
+
+// misses per task of a run that went on after them
+void printOverload(const SimResult& r,MissPolicy onMiss){
+    OverloadTotals t=overloadTotals(r.overload);
+    cout<<"Overload ("<<(onMiss==MISS_SKIP?"late jobs skipped":"late jobs continue")<<"): "<<t.missed<<" of "
+        <<t.jobs<<" jobs missed";
+    if(t.jobs)cout<<" ("<<fixed<<setprecision(2)<<100.0*t.missed/t.jobs<<"%)"<<defaultfloat;
+    cout<<", "<<t.tasksMissing<<" of "<<r.overload.size()<<" tasks missed deadlines\n";
+    for(const auto& o:r.overload){
+        cout<<o.id<<": "<<o.missed<<" of "<<o.jobs<<" jobs missed";
+        if(o.missed){
+            cout<<" ("<<fixed<<setprecision(2)<<100.0*o.missed/o.jobs<<"%), longest streak "<<o.longestStreak;
+            if(o.tardiness.count())cout<<", tardiness mean "<<o.tardiness.mean()<<", p95 "<<o.tardiness.percentile(95)
+                                       <<", max "<<o.tardiness.max();
+            cout<<defaultfloat;
+        }
+        cout<<"\n";
+    }
+}
+
+// ---------------- multiprocessor ----------------
+// Global scheduling runs the M highest priority ready jobs, one per core; a job keeps its core
+// while it stays among them and resuming anywhere else is a migration. Partitioned scheduling
+// packs the tasks onto cores with the analysis as admission test and runs the single core
+// Simulator on every core.
+
+// per core timelines: one interval per change of the job a core runs, plus the migrations
+class MulticoreTrace{
+public:
+    MulticoreTrace(int cores,bool csv,ostream& out):csv(csv),out(out){
+        if(csv)out<<"core,start,end,job,kind\n";
+        for(int c=0;c<cores;c++)sinks.emplace_back(new CoreTrace(*this,c));
+    }
+    TraceSink& core(int c){ return *sinks[c]; }
+    void migration(long long time,const string& job,int from,int to){
+        if(csv)out<<to<<','<<time<<','<<time<<','<<job<<",migration\n";
+        else out<<"At time: "<<time<<" Task"<<job<<" migrates from core "<<from<<" to core "<<to<<"\n";
+    }
+    void finish(){ for(auto& s:sinks)s->finish(); }
+private:
+    struct CoreTrace:IntervalTrace{
+        MulticoreTrace& owner;
+        int core;
+        CoreTrace(MulticoreTrace& o,int c):owner(o),core(c){}
+        void emit(const Segment& s) override{ owner.interval(core,s,names); }
+    };
+    void interval(int core,const Segment& s,const JobNames& names){
+        if(csv){
+            out<<core<<','<<s.start<<','<<s.end<<','<<names.job(s)<<','<<segmentKindName(s.kind)<<'\n';
+            return;
+        }
+        out<<"Core "<<core<<": ";
+        if(s.kind==SEG_TASK)out<<"Task"<<names.job(s)<<" runs";
+        else if(s.kind==SEG_SERVER)out<<"Server "<<names.server(s)<<" serves "<<names.job(s);
+        else if(s.kind==SEG_APERIODIC)out<<"Aperiodic Task "<<names.job(s)<<" runs";
+        else out<<"IDLE";
+        out<<" from "<<s.start<<" to "<<s.end<<"\n";
+    }
+    bool csv;
+    ostream& out;
+    vector<unique_ptr<CoreTrace>> sinks;
+};
+
+template<class PriorityPolicy>
+class GlobalSimulator{
+public:
+    GlobalSimulator(const vector<Task>& tasks,int cores,MulticoreTrace& trace,MissPolicy onMiss=MISS_ABORT,
+                    long long horizon=0);
+    SimResult run();
+    long long migrations=0;
+private:
+    typedef PriorityPolicy P;
+    TaskTable table;
+    JobNames names;
+    long long end;
+    bool bounded=false;
+    string warning;
+    vector<EventJob> jobs;
+    vector<int> lastCore;   // core a task's current job last ran on, -1 if it has not run yet
+    vector<int> coreJob;    // task running on each core in the previous segment, -1 idle
+    MulticoreTrace& trace;
+    MissPolicy onMiss;
+
+    bool before(int a,int b) const;
+};
+
+template<class P>
+GlobalSimulator<P>::GlobalSimulator(const vector<Task>& tasks,int cores,MulticoreTrace& trace,MissPolicy onMiss,
+                                    long long horizon)
+    :jobs(tasks.size()),lastCore(tasks.size(),-1),coreJob(cores,-1),trace(trace),onMiss(onMiss){
+    end=simulationEnd(tasks,&warning);
+    if(horizon>0 && (end<0 || horizon<end)){
+        end=horizon;
+        bounded=true;
+    }
+    vector<int> levels=P::levels(tasks,vector<long long>(tasks.size(),0));
+    for(size_t i=0;i<tasks.size();i++){
+        table.add(tasks[i],levels[i]);
+        names.tasks.push_back(tasks[i].id);
+    }
+    names.periodic=tasks.size();
+    for(int i=0;i<table.size();i++){
+        jobs[i].release=table.release[i];
+        jobs[i].deadline=table.release[i]+table.deadline[i];
+        jobs[i].remaining=table.exec[i];
+    }
+}
+
+// priority order, ties to the task listed first
+template<class P>
+bool GlobalSimulator<P>::before(int a,int b) const{
+    if(!P::dynamic){
+        if(table.priority[a]!=table.priority[b])return table.priority[a]>table.priority[b];
+        return a<b;
+    }
+    long long ka=P::key(jobs[a]),kb=P::key(jobs[b]);
+    if(ka!=kb)return ka<kb;
+    return a<b;
+}
+
+template<class P>
+SimResult GlobalSimulator<P>::run(){
+    SimResult result;
+    result.bounded=bounded;
+    int cores=coreJob.size();
+    if(!warning.empty())trace.core(0).warning(warning);
+    for(int c=0;c<cores;c++)trace.core(c).begin(names);
+    if(onMiss!=MISS_ABORT){
+        result.overload.resize(table.size());
+        for(int i=0;i<table.size();i++)result.overload[i].id=names.tasks[i];
+    }
+
+    vector<int> ready,running(cores);
+    long long time=0;
+    while(time<end){
+        // every task has exactly one outstanding job, so a passed deadline is a miss
+        int missed=-1;
+        for(size_t i=0;i<jobs.size();i++)
+            if(!jobs[i].late && jobs[i].deadline<=time && (missed<0 || jobs[i].deadline<jobs[missed].deadline))missed=i;
+        if(missed>=0){
+            if(!result.missed){
+                result.missed=true;
+                result.missId=names.tasks[missed];
+                result.missTime=time;
+            }
+            if(onMiss==MISS_ABORT)break;
+            for(size_t i=0;i<jobs.size();i++){
+                if(jobs[i].late || jobs[i].deadline>time)continue;
+                result.overload[i].miss();
+                if(onMiss==MISS_CONTINUE){
+                    jobs[i].late=true;
+                    continue;
+                }
+                jobs[i].release+=table.period[i];
+                jobs[i].deadline=jobs[i].release+table.deadline[i];
+                jobs[i].remaining=table.exec[i];
+                lastCore[i]=-1;
+            }
+        }
+
+        ready.clear();
+        for(size_t i=0;i<jobs.size();i++) if(jobs[i].release<=time)ready.push_back(i);
+        size_t m=min<size_t>(cores,ready.size());
+        partial_sort(ready.begin(),ready.begin()+m,ready.end(),[this](int a,int b){ return before(a,b); });
+
+        // jobs still selected stay where they ran, the others take a free core, their own if possible
+        fill(running.begin(),running.end(),-1);
+        vector<int> waiting;
+        for(size_t k=0;k<m;k++){
+            int j=ready[k];
+            if(lastCore[j]>=0 && coreJob[lastCore[j]]==j)running[lastCore[j]]=j;
+            else waiting.push_back(j);
+        }
+        for(int j:waiting){
+            int c=lastCore[j];
+            if(c<0 || running[c]>=0)c=find(running.begin(),running.end(),-1)-running.begin();
+            running[c]=j;
+            if(lastCore[j]>=0 && lastCore[j]!=c){
+                migrations++;
+                trace.migration(time,names.tasks[j],lastCore[j],c);
+            }
+            lastCore[j]=c;
+        }
+        for(int c=0;c<cores;c++){
+            int j=coreJob[c];
+            if(j>=0 && jobs[j].release<=time && find(running.begin(),running.end(),j)==running.end())
+                result.preemptions++;
+        }
+
+        long long len=end-time;
+        for(size_t i=0;i<jobs.size();i++){
+            if(jobs[i].release>time)len=min(len,jobs[i].release-time);
+            if(!jobs[i].late)len=min(len,jobs[i].deadline-time);
+        }
+        for(int j:running) if(j>=0)len=min(len,jobs[j].remaining);
+        if(P::laxity || len<1)len=1; // laxities of waiting jobs shrink every unit
+
+        for(int c=0;c<cores;c++){
+            Segment seg;
+            seg.start=time;
+            seg.end=time+len;
+            int j=running[c];
+            if(j<0){
+                seg.kind=SEG_IDLE;
+            }else{
+                seg.kind=SEG_TASK;
+                seg.job=j;
+                jobs[j].remaining-=len;
+                if(jobs[j].remaining==0){
+                    if(jobs[j].late)result.overload[j].tardiness.add(time+len-jobs[j].deadline);
+                    else if(onMiss!=MISS_ABORT)result.overload[j].hit();
+                    jobs[j].late=false;
+                    jobs[j].release+=table.period[j];
+                    jobs[j].deadline=jobs[j].release+table.deadline[j];
+                    jobs[j].remaining=table.exec[j];
+                    lastCore[j]=-1;
+                    running[c]=-1;
+                }
+            }
+            trace.core(c).segment(seg);
+        }
+        coreJob=running;
+        result.segments++;
+        time+=len;
+    }
+    result.simulatedUntil=time;
+    return result;
+}
+
+double utilisation(const vector<Task>& tasks){
+    double u=0;
+    for(const auto& t:tasks)u+=(double)t.exec_time/t.period;
+    return u;
+}
+
+// decreasing utilisation; first fit takes the lowest numbered core the analysis still accepts,
+// worst fit the least loaded one. Returns the task that fits nowhere, -1 on success.
+int partitionTasks(const vector<Task>& tasks,int cores,int choose,bool worstFit,vector<vector<Task>>& bins){
+    vector<int> order(tasks.size());
+    for(size_t i=0;i<order.size();i++)order[i]=i;
+    stable_sort(order.begin(),order.end(),[&tasks](int a,int b){
+        return (double)tasks[a].exec_time/tasks[a].period>(double)tasks[b].exec_time/tasks[b].period;
+    });
+    bins.assign(cores,{});
+    for(int i:order){
+        vector<int> candidates(cores);
+        for(int c=0;c<cores;c++)candidates[c]=c;
+        if(worstFit)stable_sort(candidates.begin(),candidates.end(),[&bins](int a,int b){
+            return utilisation(bins[a])<utilisation(bins[b]);
+        });
+        bool placed=false;
+        for(int c:candidates){
+            vector<Task> trial=bins[c];
+            trial.push_back(tasks[i]);
+            AnalysisResult a;
+            if(utilisation(trial)>1+1e-12 || !analyse(trial,choose,"",nullptr,a) || !a.schedulable)continue;
+            bins[c]=trial;
+            placed=true;
+            break;
+        }
+        if(!placed)return i;
+    }
+    return -1;
+}
+
+void scheduleMulticore(vector<Task>& tasks,ArrivalSource& aperiodicTasks,int choose,const string& serverType,
+                       Server* server,const RunOptions& opts){
+    double u=utilisation(tasks);
+    bool fits=u<=opts.cores+1e-12;
+    for(const auto& t:tasks) if(t.exec_time>t.period)fits=false;
+    if(!fits && opts.onMiss==MISS_ABORT){
+        cout<<"This task set is not schedulable";
+        return;
+    }
+    vector<vector<Task>> bins;
+    int serverCore=0;
+    if(!opts.partition.empty()){
+        int failed=partitionTasks(tasks,opts.cores,choose,opts.partition=="wfd",bins);
+        cout<<"Partition ("<<(opts.partition=="wfd"?"worst fit decreasing":"first fit decreasing")<<"):";
+        for(int c=0;c<opts.cores;c++){
+            cout<<" core "<<c<<":";
+            for(const auto& t:bins[c])cout<<" "<<t.id;
+            cout<<(c+1<opts.cores?" |":"\n");
+        }
+        if(failed>=0){
+            cout<<"Task "<<tasks[failed].id<<" does not fit on any core. Partitioning failed.\n";
+            cout<<"This task set is not schedulable";
+            return;
+        }
+        // the server and the aperiodic work go to the least loaded core
+        for(int c=1;c<opts.cores;c++) if(utilisation(bins[c])<utilisation(bins[serverCore]))serverCore=c;
+        if(!serverType.empty())cout<<"Server on core "<<serverCore<<"\n";
+    }
+
+    ofstream file;
+    if(!opts.out.empty()){
+        file.open(opts.out);
+        if(!file){
+            cerr<<"Cannot open trace file "<<opts.out<<endl;
+            return;
+        }
+    }
+    MulticoreTrace trace(opts.cores,opts.trace=="csv",opts.out.empty()?cout:file);
+    SimResult r;
+    long long migrations=0;
+    if(opts.partition.empty()){
+        if(choose==1){ GlobalSimulator<RateMonotonic> g(tasks,opts.cores,trace,opts.onMiss,opts.horizon); r=g.run(); migrations=g.migrations; }
+        else if(choose==2){ GlobalSimulator<DeadlineMonotonic> g(tasks,opts.cores,trace,opts.onMiss,opts.horizon); r=g.run(); migrations=g.migrations; }
+        else if(choose==3){ GlobalSimulator<EarliestDeadlineFirst> g(tasks,opts.cores,trace,opts.onMiss,opts.horizon); r=g.run(); migrations=g.migrations; }
+        else{ GlobalSimulator<LeastLaxityFirst> g(tasks,opts.cores,trace,opts.onMiss,opts.horizon); r=g.run(); migrations=g.migrations; }
+    }else{
+        vector<Task> noTasks;
+        VectorArrivals none(noTasks);
+        for(int c=0;c<opts.cores;c++){
+            bool here=c==serverCore && !serverType.empty();
+            SimResult cr=simulate(bins[c],here?aperiodicTasks:(ArrivalSource&)none,choose,here?serverType:"",here?server:nullptr,
+                                  trace.core(c),false,nullptr,opts.onMiss,nullptr,opts.horizon);
+            r.preemptions+=cr.preemptions;
+            r.bounded=r.bounded || cr.bounded;
+            r.overload.insert(r.overload.end(),cr.overload.begin(),cr.overload.end());
+            if(cr.missed && (!r.missed || cr.missTime<r.missTime)){
+                r.missed=true;
+                r.missId=cr.missId;
+                r.missTime=cr.missTime;
+            }
+        }
+    }
+    trace.finish();
+    printOutcome(r);
+    cout<<"Migrations: "<<migrations<<", preemptions: "<<r.preemptions<<"\n";
+    if(opts.onMiss!=MISS_ABORT)printOverload(r,opts.onMiss);
+}
+
+void printResponseStats(const string& head,const vector<long long>& response,int pending){
+    cout<<head<<": ";
+    if(response.empty()){
+        cout<<"none served ("<<pending<<" pending)\n";
+        return;
+    }
+    ResponseStats st=responseStats(response);
+    cout<<"mean "<<fixed<<setprecision(2)<<st.mean<<defaultfloat<<", p95 "<<st.p95<<", max "<<st.max
+        <<" ("<<response.size()<<" served, "<<pending<<" pending)\n";
+}
+
+void printResponseStats(const SimResult& r){
+    printResponseStats("Aperiodic response time",r.aperiodicResponse,r.aperiodicPending);
+    for(const auto& c:r.classes)printResponseStats("  class "+c.server,c.response,c.pending);
+}
+
+void printDeclaredServers(const vector<DeclaredServer>& servers){
+    cout<<"Servers:";
+    for(size_t k=0;k<servers.size();k++){
+        const DeclaredServer& s=servers[k];
+        cout<<(k?", ":" ")<<s.name<<" ("<<s.type;
+        if(budgetedServer(s.type))cout<<" "<<s.budget<<"/"<<s.period;
+        cout<<")";
+    }
+    cout<<"\n";
+}
+
+// Monte Carlo runs, below the thread pool
+void monteCarlo(const vector<Task>&,ArrivalSource&,int,const string&,const Server*,const RunOptions&,
+                const PreemptionModel&,const JobVariation&,const vector<DeclaredServer>*);
+
+// declared: the servers of the input file, which then serve the aperiodic (tagged) in place of serverType
+void schedule(vector<Task> &tasks,ArrivalSource& aperiodicTasks,int choose,const string& serverType,
+              Server* server,const RunOptions& opts,const vector<DeclaredServer>& declared,
+              const vector<Task>& aperiodic){
+    if(choose<1 || choose>6){
+        cout<<"Unknown scheduling for periodics";
+        return;
+    }
+    if(const char* mismatch=serverMismatch(choose,serverType)){
+        cout<<mismatch<<"\n";
+        return;
+    }
+    string error,note;
+    if(!declared.empty() && !serverClasses(aperiodic,declared,choose,error)){
+        cout<<error<<"\n";
+        return;
+    }
+    bool fits=declared.empty()?hyperperiodFits(tasks,budgetedServer(serverType)?server:nullptr)
+                              :hyperperiodFits(withServerTasks(tasks,declared),nullptr);
+    if(!opts.horizon && !opts.analyzeOnly && !fits){
+        cout<<"The hyperperiod exceeds 64-bit time, simulate a bounded horizon with --horizon=T.\n";
+        return;
+    }
+    if(opts.cores>1){
+        scheduleMulticore(tasks,aperiodicTasks,choose,serverType,server,opts);
+        return;
+    }
+    if(opts.onMiss==MISS_ABORT && !opts.randomJobs() && !checkFeasibility(tasks)){
+        cout<<"This task set is not schedulable";
+        return;
+    }
+    if(opts.benchRuns>0){
+        benchmark(tasks,aperiodicTasks,choose,serverType,server,opts.benchRuns,opts.input,opts.horizon,&declared);
+        return;
+    }
+    // the analysis knows a single server only
+    AnalysisResult analysis;
+    bool analysed=declared.empty() && analyse(tasks,choose,serverType,server,analysis);
+    if(analysed)printAnalysis(analysis,opts.analyzeOnly);
+    if(choose==5 && declared.empty())printPriorityOrder(tasks,serverType,server);
+    if(!declared.empty())printDeclaredServers(declared);
+    PreemptionModel model;
+    if(!preemptionModel(tasks,choose,opts,model,error,note)){
+        cout<<error<<"\n";
+        return;
+    }
+    if(!note.empty())cout<<note<<"\n";
+    printPreemptionModel(tasks,model);
+    JobVariation variation;
+    if(!jobVariation(tasks,opts,opts.seed,variation,error)){
+        cout<<error<<"\n";
+        return;
+    }
+    if(opts.analyzeOnly){
+        if(!analysed)cout<<"No analytical test for this configuration, simulate to decide.\n";
+        return;
+    }
+    if(opts.monteCarlo>0){
+        monteCarlo(tasks,aperiodicTasks,choose,serverType,server,opts,model,variation,&declared);
+        return;
+    }
+    // the analysis assumes free, immediate preemption and worst case jobs
+    if(analysed && !analysis.schedulable && analysis.exact && opts.onMiss==MISS_ABORT && !model.active()
+       && !variation.active()){
+        cout<<"This task set is not schedulable";
+        return;
+    }
+    ofstream file;
+    if(!opts.out.empty()){
+        file.open(opts.out,ios::binary);
+        if(!file){
+            cerr<<"Cannot open trace file "<<opts.out<<endl;
+            return;
+        }
+    }
+    ostream& os=opts.out.empty()?cout:file;
+    unique_ptr<TraceSink> trace;
+    if(opts.trace=="csv")trace.reset(new CsvTrace(os));
+    else if(opts.trace=="bin")trace.reset(new BinaryTrace(os));
+    else trace.reset(new LegacyTrace(serverType,os));
+    unique_ptr<RunMetrics> metrics;
+    if(!opts.metrics.empty() || choose==6)metrics.reset(new RunMetrics);
+    if(variation.active())cout<<"Random jobs, seed "<<variation.seed<<".\n";
+    auto run=[&](int algorithm,TraceSink& sink,bool tickByTick,RunMetrics* metrics){
+        return simulate(tasks,aperiodicTasks,algorithm,serverType,server,sink,tickByTick,metrics,opts.onMiss,
+                        model.active() || algorithm==6?&model:nullptr,opts.horizon,opts.steadyState,&variation,
+                        &declared);
+    };
+    SimResult r=run(choose,*trace,opts.tickByTick,metrics.get());
+    trace->finish();
+    printOutcome(r);
+    printSteadyState(r);
+    if(r.modelled)printPreemptionCounts(r,model);
+    if(choose==6){
+        SilentTrace sink;
+        RunMetrics llfMetrics;
+        SimResult llf=run(4,sink,false,&llfMetrics);
+        printLaxityComparison(model,*metrics,r,llfMetrics,llf);
+    }
+    if(opts.onMiss!=MISS_ABORT)printOverload(r,opts.onMiss);
+    if(!serverType.empty() || !declared.empty())printResponseStats(r);
+    if(!opts.metrics.empty()){
+        static const char* algorithms[]={"","RM","DM","EDF","LLF","OPA","ELLF"};
+        string head="\"algorithm\":\""+string(algorithms[choose])+"\",\"server\":"
+                    +jsonString(declared.empty()?serverType:"declared")+",";
+        if(opts.metrics=="-"){
+            writeMetrics(cout,head,*metrics,r);
+            return;
+        }
+        ofstream json(opts.metrics);
+        if(!json)cerr<<"Cannot open metrics file "<<opts.metrics<<endl;
+        else writeMetrics(json,head,*metrics,r);
+    }
+}
+
+// ---------------- batch mode ----------------
+// Every (task set, algorithm, server) combination of a directory or a multi-set file is
+// simulated on a pool of threads. Rows are kept by combination index, so the output does not
+// depend on the thread count.
+
+struct TaskSet{
+    string name;
+    vector<Task> periodic;
+    vector<Task> aperiodic;
+    vector<DeclaredServer> servers; // S lines, each serving its class of the aperiodics
+};
+
+struct ServerSpec{
+    string name;        // as printed in the summary: none, bg, poller:B:P, ds:B:P
+    string type;        // "", BG, POLLER, DS
+    long long budget=0;
+    long long period=0;
+};
+
+// the task sets of an input text: one, or several when "SET name" lines start them; the first is
+// called name until a SET line names it
+void parseTaskSets(const char* p,const char* end,const string& name,const string& prefix,vector<TaskSet>& sets){
+    sets.push_back({name,{},{},{}});
+    size_t first=sets.size()-1;
+    int p_counter=1,a_counter=1;
+    TaskLine line;
+    while(nextLine(p,end,line)){
+        size_t length=line.end-line.begin;
+        if(length>=3 && memcmp(line.begin,"SET",3)==0 && (length==3 || isBlank(line.begin[3]))){
+            string name(line.begin+3,line.end);
+            name.erase(0,name.find_first_not_of(" \t"));
+            name.erase(name.find_last_not_of(" \t\r")+1);
+            if(name.empty())name=to_string(sets.size()-first+1);
+            if(sets.back().periodic.empty() && sets.back().aperiodic.empty() && sets.back().servers.empty())
+                sets.pop_back();
+            sets.push_back({prefix.empty()?name:prefix+"/"+name,{},{},{}});
+            p_counter=a_counter=1;
+            continue;
+        }
+        if(line.type==0)continue;
+        ostringstream err;
+        TaskSet& set=sets.back();
+        if(!parseTaskLine(line,set.periodic,set.aperiodic,set.servers,p_counter,a_counter,err))
+            cerr<<sets.back().name<<": "<<err.str();
+    }
+}
+
+bool loadTaskSets(const string& path,const string& prefix,vector<TaskSet>& sets){
+    MappedFile input(path);
+    if(!input.isOpen()){
+        cerr<<"Error: "<<path<<" file could not be opened!"<<endl;
+        return false;
+    }
+    parseTaskSets(input.begin(),input.end(),prefix.empty()?path:prefix,prefix,sets);
+    return true;
+}
+
+// none | bg | background | poller:B:P | ds:B:P (any server name getServerType accepts)
+bool parseServerSpec(string text,ServerSpec& spec){
+    transform(text.begin(),text.end(),text.begin(),::tolower);
+    spec=ServerSpec();
+    if(text=="none"){
+        spec.name="none";
+        return true;
+    }
+    stringstream ss(text);
+    string kind,budget,period;
+    getline(ss,kind,':');
+    spec.type=getServerType(kind);
+    if(spec.type=="BG"){
+        spec.name="bg";
+        return !getline(ss,budget,':');
+    }
+    if(!budgetedServer(spec.type))return false;
+    if(!getline(ss,budget,':') || !getline(ss,period,':'))return false;
+    spec.budget=atoll(budget.c_str());
+    spec.period=atoll(period.c_str());
+    if(spec.budget<=0 || spec.period<=0)return false;
+    string prefix=spec.type;
+    transform(prefix.begin(),prefix.end(),prefix.begin(),::tolower);
+    spec.name=prefix+":"+budget+":"+period;
+    return true;
+}
+
+// metrics, when not null, receives the run's JSON object (nothing for runs that are not simulated).
+// A set with S lines runs its declared servers in the "none" column (named "declared"); any
+// other server serves all of its aperiodics alone, tags aside.
+string batchRow(const TaskSet& set,const string& algo,const ServerSpec& spec,const RunOptions& opts,string* metrics){
+    int choose=getAlgorithmCode(algo);
+    MissPolicy onMiss=opts.onMiss;
+    string padding=opts.limitsPreemption()?",,,,":"";
+    if(opts.steadyState)padding+=",,,";
+    bool declared=!set.servers.empty() && spec.type.empty();
+    string name=declared?"declared":spec.name;
+    vector<Task> periodic=set.periodic;
+    if(onMiss==MISS_ABORT && !checkFeasibility(periodic)) // rejected before simulating, as in a single run
+        return set.name+','+algo+','+name+",unschedulable,no,,,,,,,,"+padding;
+    Server server("ServerTask",spec.period,spec.budget);
+    const Server* sp=budgetedServer(spec.type)?&server:nullptr;
+    PreemptionModel model;
+    string error,note;
+    bool supported=declared
+        ? serverClasses(set.aperiodic,set.servers,choose,error)
+          && (opts.horizon || hyperperiodFits(withServerTasks(set.periodic,set.servers),nullptr))
+        : !serverMismatch(choose,spec.type) && (opts.horizon || hyperperiodFits(set.periodic,sp));
+    if(!supported || !preemptionModel(set.periodic,choose,opts,model,error,note))
+        return set.name+','+algo+','+name+",unsupported,,,,,,,,,"+(onMiss==MISS_ABORT?"":",,,,,,")+padding;
+    AnalysisResult analysis;
+    string verdict="unknown";
+    if(!declared && analyse(set.periodic,choose,spec.type,sp,analysis)){
+        if(analysis.schedulable)verdict="schedulable";
+        else if(analysis.exact)verdict="unschedulable";
+    }
+    SilentTrace sink;
+    unique_ptr<RunMetrics> collected;
+    if(metrics)collected.reset(new RunMetrics);
+    SimResult r=simulate(set.periodic,set.aperiodic,choose,spec.type,sp,sink,false,collected.get(),onMiss,
+                         model.active() || choose==6?&model:nullptr,opts.horizon,opts.steadyState,nullptr,
+                         declared?&set.servers:nullptr);
+    if(metrics){
+        ostringstream json;
+        writeMetrics(json,"\"set\":"+jsonString(set.name)+",\"algorithm\":"+jsonString(algo)
+                     +",\"server\":"+jsonString(name)+",",*collected,r);
+        *metrics=json.str();
+    }
 
-void earliestDeadlineFirst(vector<Task> &tasks){
-    if(!checkFeasibility(tasks)){
-        cout<<"This task set is not schedulable";
-        return;
+    ostringstream row;
+    row<<set.name<<','<<algo<<','<<name<<','<<verdict<<','<<(r.missed?"no":"yes")<<',';
+    if(r.missed)row<<r.missId<<','<<r.missTime;
+    else row<<',';
+    row<<','<<r.preemptions<<','<<r.aperiodicResponse.size()<<','<<r.aperiodicPending<<',';
+    if(!r.aperiodicResponse.empty()){
+        ResponseStats st=responseStats(r.aperiodicResponse);
+        row<<fixed<<setprecision(2)<<st.mean<<','<<st.p95<<','<<st.max;
+    }else row<<",,";
+    if(onMiss!=MISS_ABORT){
+        OverloadTotals t=overloadTotals(r.overload);
+        row<<','<<t.jobs<<','<<t.missed<<','<<fixed<<setprecision(4)<<(t.jobs?(double)t.missed/t.jobs:0)
+           <<','<<t.tasksMissing<<','<<t.longestStreak<<','<<t.maxTardiness;
     }
-     for (auto &t : tasks) {
-        t.absolute_deadline = t.release_time + t.deadline_relative;
-        t.remaining_exec = t.exec_time;
-        t.isActive       = false;
+    if(opts.limitsPreemption())
+        row<<','<<r.switches<<','<<r.overhead<<','<<r.deferredPreemptions<<','<<r.avoidedPreemptions;
+    if(opts.steadyState){
+        row<<','<<r.simulatedUntil<<',';
+        if(r.cycleLength>0)row<<r.cycleStart<<','<<r.cycleLength;
+        else row<<',';
     }
-    
-    int hyperperiod=calculate_hyperperiod(tasks);
-    int firstSimoultaneous=findFirstSimultaneousRelease(tasks);
-    vector<Task> currentTasks=tasks;
-    for(int time=0; time<hyperperiod+firstSimoultaneous+1; time++){
-        for(auto &ct:currentTasks){
-            if(ct.absolute_deadline<=time){
-                cout<<"Deadline missed for "<< ct.id<<" at " <<time <<". Algorithm is failed.\n";
-                return;
+    return row.str();
+}
+
+// simulated time units and scheduling decisions per second of every algorithm/server pair over
+// all task sets, on one thread so the figures stay comparable between runs
+void benchmarkBatch(const vector<TaskSet>& sets,const vector<string>& algos,const vector<ServerSpec>& servers,
+                    int runs,long long horizon,ostream& out){
+    out<<"algorithm,server,sets,time_units,events,seconds,time_units_per_s,events_per_s\n";
+    for(const auto& algo:algos){
+        int choose=getAlgorithmCode(algo);
+        for(const auto& spec:servers){
+            Server server("ServerTask",spec.period,spec.budget);
+            const Server* sp=budgetedServer(spec.type)?&server:nullptr;
+            if(serverMismatch(choose,spec.type))continue;
+            SilentTrace sink;
+            long long units=0,events=0;
+            int used=0;
+            auto begin=chrono::steady_clock::now();
+            for(const auto& set:sets){
+                vector<Task> periodic=set.periodic;
+                if(!checkFeasibility(periodic) || (!horizon && !hyperperiodFits(periodic,sp)))continue;
+                used++;
+                for(int i=0;i<runs;i++){
+                    SimResult r=simulate(set.periodic,set.aperiodic,choose,spec.type,sp,sink,false,nullptr,
+                                         MISS_ABORT,nullptr,horizon);
+                    units+=r.simulatedUntil;
+                    events+=r.segments;
+                }
             }
+            double seconds=max(chrono::duration<double>(chrono::steady_clock::now()-begin).count(),1e-9);
+            out<<algo<<','<<spec.name<<','<<used<<','<<units<<','<<events<<','<<seconds<<','
+               <<units/seconds<<','<<events/seconds<<'\n';
         }
+    }
+}
 
-        for (auto &task : currentTasks) if(task.release_time<=time)task.isActive=true;
-
-        sortByEarliestDeadline(currentTasks);
-        int runningTaskIndex=0;
+// every task set of a directory (one per file, by file name) or of a multi-set file
+bool loadBatchInput(const string& path,vector<TaskSet>& sets){
+    error_code ec;
+    if(filesystem::is_directory(path,ec)){
+        vector<filesystem::path> files;
+        for(const auto& entry:filesystem::directory_iterator(path,ec))
+            if(entry.is_regular_file())files.push_back(entry.path());
+        sort(files.begin(),files.end());
+        for(const auto& f:files)loadTaskSets(f.string(),f.filename().string(),sets);
+        return true;
+    }
+    return loadTaskSets(path,"",sets);
+}
 
-        for (auto &task : currentTasks){
-            if(task.isActive==false)runningTaskIndex++;
-            else break;
+// "rm,edf" and "none,ds:1:4" lists of the command line; false after printing what is wrong
+bool parseBatchLists(const string& algoList,const string& serverList,vector<string>& algos,
+                     vector<ServerSpec>& servers){
+    stringstream as(algoList);
+    for(string a;getline(as,a,',');){
+        transform(a.begin(),a.end(),a.begin(),::tolower);
+        if(getAlgorithmCode(a)==0){
+            cerr<<"Wrong scheduling algorithm (Only RM, DM, EDF, LLF, OPA, ELLF)."<<endl;
+            return false;
         }
-        if(runningTaskIndex==currentTasks.size()){
-            cout<<time<<" is IDLE\n";
-            continue;
-        }
-        cout<<"At time: "<< time<<" Task" << currentTasks[runningTaskIndex].id<<" is running\n";
-
-        currentTasks[runningTaskIndex].remaining_exec--;
-        if(currentTasks[runningTaskIndex].remaining_exec==0){
-            Task oldTask=currentTasks[runningTaskIndex];
-            Task newTask=oldTask;
-
-            newTask.isActive=false;
-            newTask.release_time=oldTask.release_time+oldTask.period;
-            newTask.absolute_deadline=newTask.release_time+newTask.deadline_relative;
-            newTask.remaining_exec=newTask.exec_time;
-
-            currentTasks.erase(currentTasks.begin()+runningTaskIndex);
-            currentTasks.push_back(newTask);
+        algos.push_back(a);
+    }
+    stringstream ss(serverList);
+    for(string t;getline(ss,t,',');){
+        ServerSpec spec;
+        if(!parseServerSpec(t,spec)){
+            cerr<<"Wrong server: "<<t<<" (none, bg, poller:BUDGET:PERIOD, ds:BUDGET:PERIOD)"<<endl;
+            return false;
         }
+        servers.push_back(spec);
     }
-    cout<<"Successfully scheduled until hyperperiod.\n";
+    return true;
 }
 
-void leastLaxityFirst(vector<Task> &tasks){
-    if(!checkFeasibility(tasks)){
-        cout<<"This task set is not schedulable";
-        return;
-    }
-     for (auto &t : tasks) {
-        t.absolute_deadline = t.release_time + t.deadline_relative;
-        t.remaining_exec = t.exec_time;
-        t.isActive       = false;
-        t.priority=0.0;
-    }
-    
-    int hyperperiod=calculate_hyperperiod(tasks);
-    int firstSimoultaneous=findFirstSimultaneousRelease(tasks);
-    vector<Task> currentTasks=tasks;
-    for(int time=0; time<hyperperiod+firstSimoultaneous+1; time++){
-        for(auto &ct:currentTasks){
-            if(ct.absolute_deadline<=time){
-                cout<<"Deadline missed for "<< ct.id<<" at " <<time <<". Algorithm is failed.\n";
-                return;
-            }
-        }
+// runs job(0..total-1) on the given number of threads (0 for one per core), each index exactly once
+template<typename Job>
+void runPool(size_t total,int threads,Job job){
+    atomic<size_t> next(0);
+    auto worker=[&](){
+        for(size_t i=next++;i<total;i=next++)job(i);
+    };
+    if(threads<=0)threads=max(1u,thread::hardware_concurrency());
+    threads=(int)min<size_t>(threads,max<size_t>(total,1));
+    vector<thread> pool;
+    for(int t=1;t<threads;t++)pool.emplace_back(worker);
+    worker();
+    for(auto& t:pool)t.join();
+}
 
-        for (auto &task : currentTasks) if(task.release_time<=time)task.isActive=true;
-        
-        for (auto& task : currentTasks) task.priority = task.absolute_deadline - task.remaining_exec - time;
+int runBatch(const string& path,const string& algoList,const string& serverList,const RunOptions& opts,ostream& out){
+    vector<TaskSet> sets;
+    if(!loadBatchInput(path,sets))return 1;
 
+    vector<string> algos;
+    vector<ServerSpec> servers;
+    if(!parseBatchLists(algoList,serverList,algos,servers))return 1;
+    if(opts.benchRuns>0){
+        benchmarkBatch(sets,algos,servers,opts.benchRuns,opts.horizon,out);
+        return 0;
+    }
 
-        sortByLeastLaxity(currentTasks);
-        int runningTaskIndex=0;
+    size_t perSet=algos.size()*servers.size();
+    size_t total=sets.size()*perSet;
+    vector<string> rows(total);
+    vector<string> metrics(opts.metrics.empty()?0:total);
+    runPool(total,opts.threads,[&](size_t i){
+        size_t k=i%perSet;
+        rows[i]=batchRow(sets[i/perSet],algos[k/servers.size()],servers[k%servers.size()],opts,
+                         metrics.empty()?nullptr:&metrics[i]);
+    });
 
-        for (auto &task : currentTasks){
-            if(task.isActive==false)runningTaskIndex++;
-            else break;
+    out<<"set,algorithm,server,analysis,schedulable,first_miss,miss_time,preemptions,"
+         "aperiodic_served,aperiodic_pending,aperiodic_mean_response,aperiodic_p95_response,aperiodic_max_response";
+    if(opts.onMiss!=MISS_ABORT)out<<",jobs,missed_jobs,miss_ratio,tasks_missing,longest_miss_streak,max_tardiness";
+    if(opts.limitsPreemption())out<<",switches,switch_overhead,deferred_preemptions,avoided_preemptions";
+    if(opts.steadyState)out<<",simulated_until,cycle_start,cycle_length";
+    out<<'\n';
+    for(const auto& r:rows)out<<r<<'\n';
+    if(!opts.metrics.empty()){
+        // a JSON array, one simulated combination per line
+        ofstream json(opts.metrics);
+        if(!json){
+            cerr<<"Cannot open metrics file "<<opts.metrics<<endl;
+            return 1;
         }
-        if(runningTaskIndex==currentTasks.size()){
-            cout<<time<<" is IDLE\n";
-            continue;
+        json<<"[\n";
+        bool first=true;
+        for(auto& m:metrics){
+            if(m.empty())continue;
+            if(!first)json<<",\n";
+            m.pop_back(); // newline
+            json<<m;
+            first=false;
         }
-        cout<<"At time: "<< time<<" Task" << currentTasks[runningTaskIndex].id<<" is running\n";
+        json<<"\n]\n";
+    }
+    return 0;
+}
 
-        currentTasks[runningTaskIndex].remaining_exec--;
-        if(currentTasks[runningTaskIndex].remaining_exec==0){
-            Task oldTask=currentTasks[runningTaskIndex];
-            Task newTask=oldTask;
+// ---------------- sensitivity analysis ----------------
+// The critical scaling factor: the largest multiplier of the execution times that keeps a task
+// set schedulable, for all periodic tasks at once and for each task alone. Every (set, algorithm,
+// server, scaled task) search is a job on the thread pool; a search point is decided by the
+// analysis where it is conclusive and by simulating to the hyperperiod otherwise.
+// Execution times are whole time units, so a factor of 1.01 would round C=1 up to 2. The searches
+// therefore run on a finer clock: every time of the set is multiplied by a resolution of up to 100,
+// less where the scaled run would no longer end within 64-bit time.
 
-            newTask.isActive=false;
-            newTask.release_time=oldTask.release_time+oldTask.period;
-            newTask.absolute_deadline=newTask.release_time+newTask.deadline_relative;
-            newTask.remaining_exec=newTask.exec_time;
+struct SensitivityProbe{
+    int choose;
+    string serverType;
+    int resolution=1;
+    long long horizon=0;    // --horizon on the fine clock, 0 for the whole hyperperiod
+    bool steadyState=false; // simulations stop once the schedule repeats
+    vector<Task> periodic;  // on the fine clock
+    vector<Task> aperiodic;
+    unique_ptr<Server> server;
+    PreemptionModel model;  // only the ELLF laxity threshold, preemption stays free
+    bool analysed=false;    // some point was decided by the analysis
+    bool simulated=false;   // some point needed the simulator
 
-            currentTasks.erase(currentTasks.begin()+runningTaskIndex);
-            currentTasks.push_back(newTask);
+    SensitivityProbe(const TaskSet& set,int c,const ServerSpec& spec,long long laxityThreshold,long long bound,
+                     bool steady)
+        :choose(c),serverType(spec.type),steadyState(steady),periodic(set.periodic),aperiodic(set.aperiodic){
+        model.laxityThreshold=laxityThreshold;
+        // every time scales with the resolution, the simulated span and the hyperperiod with it
+        vector<Task> all=periodic;
+        if(budgetedServer(spec.type))all.push_back(Task("ServerTask",0,spec.budget,spec.period,spec.period));
+        string ignored;
+        long long span=bound?bound:simulationEnd(all,&ignored),longest=max(spec.period,1LL);
+        for(const auto& t:periodic)longest=max(longest,max(max(t.period,t.deadline_relative),t.release_time));
+        long long work=0,last=0;
+        for(const auto& a:aperiodic){
+            work=min(work+a.exec_time,LLONG_MAX/8);
+            last=max(last,a.release_time);
+        }
+        longest=max(longest,min(last+work,LLONG_MAX/8));
+        while(span>=0 && resolution<100){
+            long long r=resolution+1;
+            if(span+longest>LLONG_MAX/4/r)break;
+            resolution++;
         }
+        horizon=bound*resolution;
+        for(auto& t:periodic){
+            t.release_time*=resolution;
+            t.exec_time*=resolution;
+            t.period*=resolution;
+            t.deadline_relative*=resolution;
+        }
+        for(auto& a:aperiodic){
+            a.release_time*=resolution;
+            a.exec_time*=resolution;
+        }
+        if(budgetedServer(spec.type))
+            server.reset(new Server("ServerTask",spec.period*resolution,spec.budget*resolution));
     }
-    cout<<"Successfully scheduled until hyperperiod.\n";
-}
 
-void backgroundServer(vector<Task> &tasks,vector<Task> &aperiodicTasks,int choose){
-    //1 for rm 2 for dm 3 for edf 4 for llf
-    if(choose!=1 && choose!=2 && choose!=3 && choose!=4){
-        cout<<"Unknown scheduling for periodics";
-        return;
+    bool schedulable(vector<Task>& set){
+        if(!checkFeasibility(set)){
+            analysed=true;
+            return false;
+        }
+        AnalysisResult a;
+        if(analyse(set,choose,serverType,server.get(),a) && (a.schedulable || a.exact)){
+            analysed=true;
+            return a.schedulable;
+        }
+        simulated=true;
+        SilentTrace sink;
+        return !simulate(set,aperiodic,choose,serverType,server.get(),sink,false,nullptr,MISS_ABORT,&model,
+                         horizon,steadyState).missed;
     }
-    if(!checkFeasibility(tasks)){
-        cout<<"This task set is not schedulable";
-        return;
+    // largest execution time of task i on the fine clock, the others unchanged; 0 if none fits
+    long long criticalExecTime(size_t i){
+        vector<Task> set=periodic;
+        long long lo=0,hi=min(set[i].period,set[i].deadline_relative);
+        while(lo<hi){
+            long long mid=lo+(hi-lo+1)/2;
+            set[i].exec_time=mid;
+            if(schedulable(set))lo=mid;
+            else hi=mid-1;
+        }
+        return lo;
     }
-     for (auto &t : tasks) {
-        t.absolute_deadline = t.release_time + t.deadline_relative;
-        t.remaining_exec = t.exec_time;
-        t.isActive       = false;
-        if(choose==1)t.priority=1.0f/t.period;
-        else if(choose==2)t.priority=1.0f/t.deadline_relative; // as they are static priorities
-    }
-    for(auto &at: aperiodicTasks){
-        at.absolute_deadline=INT_MAX;
-        at.period=INT_MAX;
-        at.deadline_relative=INT_MAX;
-        at.isActive=false;
-        at.remaining_exec=at.exec_time;
-    }
-
-    int hyperperiod=calculate_hyperperiod(tasks);
-    int firstSimoultaneous=findFirstSimultaneousRelease(tasks);
-    vector<Task> currentTasks=tasks;
-    vector<Task> currentAperiodics=aperiodicTasks;
-
-    for(int time=0; time<hyperperiod+firstSimoultaneous+1; time++){
-        for(auto &ct:currentTasks){
-            if(ct.absolute_deadline<=time){
-                cout<<"Deadline missed for "<< ct.id<<" at " <<time <<". Algorithm is failed.\n";
-                return;
-            }
-        }
-
-        for (auto &task : currentTasks) if(task.release_time<=time)task.isActive=true;
-
-        if(choose==1 || choose==2) sortByExplicitPriority(currentTasks);
-        if(choose==3)sortByEarliestDeadline(currentTasks); // 3 and 4 are dynamic priorities
-        if(choose==4){
-            for (auto& task : currentTasks) task.priority = task.absolute_deadline - task.remaining_exec - time;
-            sortByLeastLaxity(currentTasks);
-        }
-
-        int runningTaskIndex=0;
-        for (auto &task : currentTasks){
-            if(task.isActive==false)runningTaskIndex++;
-            else break;
-        }
-        //handling aperiodic tasks here
-        if(runningTaskIndex==currentTasks.size()){
-            cout<<"System can run aperiodic task at time:"<< time <<".\n";
-            if(currentAperiodics.empty()){
-                cout<<"But there is no aperiodic Task. It is IDLE time\n";
-                continue;
-            }
-            sortTasksByReleaseTime(currentAperiodics); // first come first serve(the one first came at the first index of array)
-            if(currentAperiodics[0].release_time<=time){
-                currentAperiodics[0].remaining_exec--;
-                cout<<"Aperiodic Task: "<<currentAperiodics[0].id<<" is running.\n";
-                if(currentAperiodics[0].remaining_exec==0){
-                    currentAperiodics.erase(currentAperiodics.begin());
-                }
-            }else{
-                cout<<"But no aperiodic task released yet. It is IDLE time\n";
-            }
-            continue;
+    // all execution times scaled by f, rounded up; the supremum is where some ceil(C*f) steps, so
+    // the bisection ends by moving up to the end of the step it found
+    double criticalFactor(){
+        vector<Task> set=periodic;
+        double u=0;
+        for(const auto& t:set)u+=(double)t.exec_time/t.period;
+        auto scaled=[&](double f){
+            for(size_t i=0;i<set.size();i++)
+                set[i].exec_time=max(1LL,(long long)ceil(periodic[i].exec_time*f-1e-9));
+            return schedulable(set);
+        };
+        double lo=0,hi=1/u+1e-9;
+        if(scaled(hi))return hi;
+        while(hi-lo>1e-4){
+            double mid=(lo+hi)/2;
+            if(scaled(mid))lo=mid;
+            else hi=mid;
         }
+        if(lo==0)return 0;
+        double end=hi;
+        for(const auto& t:periodic)end=min(end,ceil(t.exec_time*lo-1e-9)/t.exec_time);
+        return max(lo,end);
+    }
+    const char* method() const {
+        return simulated?(analysed?"analysis+simulation":"simulation"):"analysis";
+    }
+};
 
-        cout<<"At time: "<< time<<" Task" << currentTasks[runningTaskIndex].id<<" is running\n";
-
-        currentTasks[runningTaskIndex].remaining_exec--;
-        if(currentTasks[runningTaskIndex].remaining_exec==0){
-            Task oldTask=currentTasks[runningTaskIndex];
-            Task newTask=oldTask;
-
-            newTask.isActive=false;
-            newTask.release_time=oldTask.release_time+oldTask.period;
-            newTask.absolute_deadline=newTask.release_time+newTask.deadline_relative;
-            newTask.remaining_exec=newTask.exec_time;
+// set,algorithm,server,task,wcet,critical_wcet,scaling_factor,method,resolution; task "all" scales
+// every periodic task, critical_wcet is in the time units of the input
+int runSensitivity(const string& path,const string& algoList,const string& serverList,const RunOptions& opts,
+                   ostream& out){
+    vector<TaskSet> sets;
+    if(!loadBatchInput(path,sets))return 1;
+    vector<string> algos;
+    vector<ServerSpec> servers;
+    if(!parseBatchLists(algoList,serverList,algos,servers))return 1;
 
-            currentTasks.erase(currentTasks.begin()+runningTaskIndex);
-            currentTasks.push_back(newTask);
+    struct Search{ size_t set,algo,server; int task; }; // task -1: all tasks
+    vector<Search> searches;
+    for(size_t s=0;s<sets.size();s++)
+        for(size_t a=0;a<algos.size();a++)
+            for(size_t v=0;v<servers.size();v++)
+                for(int t=-1;t<(int)sets[s].periodic.size();t++)searches.push_back({s,a,v,t});
+    vector<string> rows(searches.size());
+    runPool(searches.size(),opts.threads,[&](size_t i){
+        const Search& k=searches[i];
+        const TaskSet& set=sets[k.set];
+        const ServerSpec& spec=servers[k.server];
+        int choose=getAlgorithmCode(algos[k.algo]);
+        ostringstream row;
+        row<<set.name<<','<<algos[k.algo]<<','<<spec.name<<','<<(k.task<0?"all":set.periodic[k.task].id)<<',';
+        if(k.task>=0)row<<set.periodic[k.task].exec_time;
+        row<<',';
+        Server server("ServerTask",spec.period,spec.budget);
+        if(serverMismatch(choose,spec.type) || set.periodic.empty()
+           || (!opts.horizon && !hyperperiodFits(set.periodic,budgetedServer(spec.type)?&server:nullptr))){
+            row<<",,unsupported,";
+            rows[i]=row.str();
+            return;
         }
-    }
-    cout<<"Successfully scheduled until hyperperiod.\n";
+        SensitivityProbe probe(set,choose,spec,opts.laxityThreshold,opts.horizon,opts.steadyState);
+        double factor;
+        row<<fixed<<setprecision(2);
+        if(k.task<0)factor=probe.criticalFactor();
+        else{
+            long long c=probe.criticalExecTime(k.task);
+            row<<(double)c/probe.resolution;
+            factor=(double)c/probe.periodic[k.task].exec_time;
+        }
+        // rounded down, so the printed factor is still schedulable
+        row<<','<<setprecision(3)<<floor(factor*1000+1e-6)/1000<<','<<probe.method()<<','<<probe.resolution;
+        rows[i]=row.str();
+    });
+
+    out<<"set,algorithm,server,task,wcet,critical_wcet,scaling_factor,method,resolution\n";
+    for(const auto& r:rows)out<<r<<'\n';
+    return 0;
 }
 
-struct Server{
-    string ID;
-    int period;
-    int budget;
-    Server(string id,int p,int b):ID(id),period(p),budget(b){}
-};
-void pollerServer(vector<Task> &tasks,vector<Task> &aperiodicTasks,int choose,Server& poller){
-    //1 for rm 2 for dm 3 for edf 4 for llf
-    if(choose!=1 && choose!=2 && choose!=3 && choose!=4){
-        cout<<"Unknown scheduling for periodics";
-        return;
-    }
-    if(!checkFeasibility(tasks)){
-        cout<<"This task set is not schedulable";
-        return;
-    }
+// ---------------- server sweep ----------------
+// Budget and period of the aperiodic server over a grid, for every (task set, algorithm, server
+// type): points whose utilisation, periodic tasks included, is above 1 or that the analysis proves
+// unschedulable are dropped without simulating, the rest are simulated on the thread pool. Of the
+// points that meet every deadline only the Pareto front is printed: no other point has a lower or
+// equal server utilisation, mean and p99 aperiodic response time and pending aperiodic jobs with
+// one of them strictly lower.
 
-    Task serverTask(poller.ID,0,poller.budget,poller.period,poller.period);
-    serverTask.isActive=true;
-    tasks.push_back(serverTask);
+struct SweepGrid{
+    long long minPeriod=0,maxPeriod=0;
+    long long periodStep=1,budgetStep=1;
+};
 
-    for (auto &t : tasks) {
-        t.absolute_deadline = t.release_time + t.deadline_relative;
-        t.remaining_exec = t.exec_time;
-        t.isActive       = false;
-        if(choose==1)t.priority=1.0f/t.period;
-        else if(choose==2)t.priority=1.0f/t.deadline_relative; // as they are static priorities
+// PMIN:PMAX[:PSTEP[:BSTEP]], budgets go 1, 1+BSTEP, ... up to the period
+bool parseSweepGrid(const string& text,SweepGrid& grid){
+    stringstream ss(text);
+    vector<long long> v;
+    for(string part;getline(ss,part,':');){
+        char* end;
+        long long x=strtoll(part.c_str(),&end,10);
+        if(part.empty() || *end || x<=0)return false;
+        v.push_back(x);
     }
+    if(v.size()<2 || v.size()>4 || v[0]>v[1])return false;
+    grid.minPeriod=v[0];
+    grid.maxPeriod=v[1];
+    if(v.size()>2)grid.periodStep=v[2];
+    if(v.size()>3)grid.budgetStep=v[3];
+    return true;
+}
 
-    sortTasksByReleaseTime(aperiodicTasks);
-    for(auto &at: aperiodicTasks){
-        at.absolute_deadline=INT_MAX;
-        at.period=INT_MAX;
-        at.deadline_relative=INT_MAX;
-        at.isActive=false;
-        at.remaining_exec=at.exec_time;
+struct SweepPoint{
+    size_t group;           // (set, algorithm, server type) index
+    long long budget,period;
+    bool met=false;         // simulated without a deadline miss
+    long long served=0,pending=0;
+    ResponseStats stats;
+    double utilisation() const { return (double)budget/period; }
+    bool dominates(const SweepPoint& o) const {
+        bool le=utilisation()<=o.utilisation() && stats.mean<=o.stats.mean && stats.p99<=o.stats.p99
+                && pending<=o.pending;
+        return le && (utilisation()<o.utilisation() || stats.mean<o.stats.mean || stats.p99<o.stats.p99
+                      || pending<o.pending);
     }
+};
 
-    int hyperperiod=calculate_hyperperiod(tasks);
-    int firstSimoultaneous=findFirstSimultaneousRelease(tasks);
-    vector<Task> currentTasks=tasks;
-    vector<Task> currentAperiodics=aperiodicTasks;
+// set,algorithm,server,budget,period,server_utilisation,aperiodic_served,aperiodic_pending,
+// aperiodic_mean_response,aperiodic_p99_response,aperiodic_max_response,points,pruned,missed;
+// a group without a schedulable point gets one row with the counts only, an algorithm the server
+// type does not work with one marked unsupported
+int runSweep(const string& path,const string& algoList,const string& serverList,const RunOptions& opts,ostream& out){
+    SweepGrid grid;
+    if(!parseSweepGrid(opts.sweep,grid)){
+        cerr<<"Wrong sweep grid (--sweep=PMIN:PMAX[:PSTEP[:BSTEP]], positive, PMIN<=PMAX)."<<endl;
+        return 1;
+    }
+    vector<TaskSet> sets;
+    if(!loadBatchInput(path,sets))return 1;
+    vector<string> algos;
+    vector<ServerSpec> servers;
+    if(!parseBatchLists(algoList,"none",algos,servers))return 1;
+    vector<string> types;
+    stringstream ts(serverList);
+    for(string t;getline(ts,t,',');){
+        string type=getServerType(t);
+        if(!budgetedServer(type)){
+            cerr<<"Wrong sweep server: "<<t<<" (poller, ds, ss, tbs, cbs)"<<endl;
+            return 1;
+        }
+        types.push_back(type);
+    }
 
-    int usedBudget=0;
-    for(int time=0; time<hyperperiod+firstSimoultaneous+1; time++){
-        for(auto &ct:currentTasks){
-            if(ct.id==poller.ID)continue;
-            if(ct.absolute_deadline<=time){
-                cout<<"Deadline missed for "<< ct.id<<" at " <<time <<". Algorithm is failed.\n";
-                return;
+    struct Group{ size_t set,algo,type; long long points=0,pruned=0,missed=0; bool supported=true; };
+    vector<Group> groups;
+    vector<SweepPoint> points;
+    vector<PreemptionModel> models;
+    for(size_t s=0;s<sets.size();s++){
+        double u=0;
+        for(const auto& t:sets[s].periodic)u+=(double)t.exec_time/t.period;
+        for(size_t a=0;a<algos.size();a++){
+            int choose=getAlgorithmCode(algos[a]);
+            PreemptionModel model;
+            string error,note;
+            bool modelled=preemptionModel(sets[s].periodic,choose,opts,model,error,note);
+            for(size_t v=0;v<types.size();v++){
+                Group g{s,a,v};
+                g.supported=modelled && !serverMismatch(choose,types[v]);
+                groups.push_back(g);
+                models.push_back(model);
+                if(!g.supported)continue;
+                Group& group=groups.back();
+                for(long long period=grid.minPeriod;period<=grid.maxPeriod;period+=grid.periodStep)
+                    for(long long budget=1;budget<=period;budget+=grid.budgetStep){
+                        group.points++;
+                        // larger budgets of this period only add utilisation
+                        if(u+(double)budget/period>1+1e-9){
+                            group.pruned+=(period-budget)/grid.budgetStep+1;
+                            group.points+=(period-budget)/grid.budgetStep;
+                            break;
+                        }
+                        Server server("ServerTask",period,budget);
+                        AnalysisResult analysis;
+                        if((!opts.horizon && !hyperperiodFits(sets[s].periodic,&server))
+                           || (analyse(sets[s].periodic,choose,types[v],&server,analysis)
+                               && !analysis.schedulable && analysis.exact)){
+                            group.pruned++;
+                            continue;
+                        }
+                        SweepPoint p;
+                        p.group=groups.size()-1;
+                        p.budget=budget;
+                        p.period=period;
+                        points.push_back(p);
+                    }
             }
         }
-        for (auto &task : currentTasks) if(task.release_time<=time)task.isActive=true;
+    }
 
-        if(choose==1 || choose==2) sortByExplicitPriority(currentTasks);
-        if(choose==3)sortByEarliestDeadline(currentTasks); // 3 and 4 are dynamic priorities
-        if(choose==4){
-            for (auto& task : currentTasks) task.priority = task.absolute_deadline - task.remaining_exec - time;
-            sortByLeastLaxity(currentTasks);
-        }
+    runPool(points.size(),opts.threads,[&](size_t i){
+        SweepPoint& p=points[i];
+        const Group& g=groups[p.group];
+        const TaskSet& set=sets[g.set];
+        int choose=getAlgorithmCode(algos[g.algo]);
+        const PreemptionModel& model=models[p.group];
+        Server server("ServerTask",p.period,p.budget);
+        SilentTrace sink;
+        SimResult r=simulate(set.periodic,set.aperiodic,choose,types[g.type],&server,sink,false,nullptr,MISS_ABORT,
+                             model.active() || choose==6?&model:nullptr,opts.horizon,opts.steadyState);
+        p.met=!r.missed;
+        p.served=r.aperiodicResponse.size();
+        p.pending=r.aperiodicPending;
+        p.stats=responseStats(move(r.aperiodicResponse));
+    });
 
-        if(time%poller.period==0){
-            usedBudget=0;
-            for(auto & at:currentAperiodics){
-                if(at.release_time<=time){
-                    if(at.remaining_exec<=poller.budget-usedBudget){
-                        usedBudget+=at.remaining_exec;
-                    }else{
-                        usedBudget=poller.budget;
-                    }   
+    // the points of a group are contiguous; sorted by utilisation first, a point can only be
+    // dominated by one before it, and whatever dominates it is dominated by a front point
+    vector<vector<const SweepPoint*>> fronts(groups.size());
+    vector<const SweepPoint*> order;
+    for(size_t i=0;i<points.size();){
+        size_t j=i;
+        order.clear();
+        for(;j<points.size() && points[j].group==points[i].group;j++){
+            if(points[j].met)order.push_back(&points[j]);
+            else groups[points[j].group].missed++;
+        }
+        sort(order.begin(),order.end(),[](const SweepPoint* a,const SweepPoint* b){
+            double ua=a->utilisation(),ub=b->utilisation();
+            if(ua!=ub)return ua<ub;
+            if(a->stats.mean!=b->stats.mean)return a->stats.mean<b->stats.mean;
+            if(a->stats.p99!=b->stats.p99)return a->stats.p99<b->stats.p99;
+            return a->pending<b->pending;
+        });
+        auto& front=fronts[points[i].group];
+        for(const SweepPoint* p:order){
+            bool dominated=false;
+            for(const SweepPoint* f:front)
+                if(f->dominates(*p)){
+                    dominated=true;
+                    break;
                 }
-                if(usedBudget==poller.budget)break;
-            }
-            for(auto& t:currentTasks){
-                if(t.id==poller.ID)t.remaining_exec=usedBudget;
-            }
+            if(!dominated)front.push_back(p);
         }
+        i=j;
+    }
 
-        int runningTaskIndex=0;
-        for (auto &task : currentTasks){
-            if(task.isActive==false)runningTaskIndex++;
-            else{
-                if(task.id==poller.ID && task.remaining_exec==0){
-                    runningTaskIndex++;
-                }else break;
-            } 
-        }
-        
-        if(runningTaskIndex==currentTasks.size()){
-            cout<<"System is Idle at "<< time <<".\n";
+    out<<"set,algorithm,server,budget,period,server_utilisation,aperiodic_served,aperiodic_pending,"
+         "aperiodic_mean_response,aperiodic_p99_response,aperiodic_max_response,points,pruned,missed\n";
+    for(size_t k=0;k<groups.size();k++){
+        const Group& g=groups[k];
+        string type=types[g.type];
+        transform(type.begin(),type.end(),type.begin(),::tolower);
+        string prefix=sets[g.set].name+','+algos[g.algo]+','+type+',';
+        ostringstream counts;
+        counts<<','<<g.points<<','<<g.pruned<<','<<g.missed;
+        if(!g.supported){
+            out<<prefix<<"unsupported,,,,,,,,,,\n";
             continue;
         }
-
-        Task& running=currentTasks[runningTaskIndex];
-        if(running.id==poller.ID){
-            cout << "At time: " << time << " Server " << running.id 
-            << " serving " << currentAperiodics[0].id 
-            << " (budget: " << running.remaining_exec << ")\n";
-
-            running.remaining_exec--;
-            currentAperiodics[0].remaining_exec--; //if we have no ready aperiodic task server.remaining_exec will be 0 so runningtask index will never be here 
-            if(currentAperiodics[0].remaining_exec==0){
-                currentAperiodics.erase(currentAperiodics.begin());
-            }
-            continue;
+        if(fronts[k].empty())out<<prefix<<",,,,,,,"<<counts.str()<<'\n';
+        for(const SweepPoint* p:fronts[k]){
+            out<<prefix<<p->budget<<','<<p->period<<','<<fixed<<setprecision(4)<<p->utilisation()<<','
+               <<p->served<<','<<p->pending<<',';
+            if(p->served)out<<setprecision(2)<<p->stats.mean<<','<<p->stats.p99<<','<<p->stats.max;
+            else out<<",,";
+            out<<counts.str()<<'\n';
         }
+    }
+    return 0;
+}
 
-        cout<<"At time: "<< time<<" Task" << currentTasks[runningTaskIndex].id<<" is running\n";
-
-        currentTasks[runningTaskIndex].remaining_exec--;
-        if(currentTasks[runningTaskIndex].remaining_exec==0){
-            Task oldTask=currentTasks[runningTaskIndex];
-            Task newTask=oldTask;
-            
-            newTask.isActive=false;
-            newTask.release_time=oldTask.release_time+oldTask.period;
-            newTask.absolute_deadline=newTask.release_time+newTask.deadline_relative;
-            newTask.remaining_exec=newTask.exec_time;
+// ---------------- Monte Carlo ----------------
+// Many runs of one task set with random jobs (JobVariation), run k seeded with seed+k, on the
+// thread pool. Every run covers the hyperperiod (or --horizon) as usual. Under --on-miss=abort a
+// run ends at its first miss, so what is estimated is the probability that a run misses; with
+// skip or continue every job is counted as well. Runs go in chunks of a fixed size and only the
+// chunk totals, all integer counts, are merged, so the report is the same for every thread count.
 
-            currentTasks.erase(currentTasks.begin()+runningTaskIndex);
-            currentTasks.push_back(newTask);
+struct MonteCarloTotals{
+    long long runs=0;
+    long long missedRuns=0;
+    vector<long long> firstMisses;     // per task: runs whose first miss was a job of this task
+    vector<Histogram> response;        // per task: finish - arrival of every completed job
+    vector<long long> jobs,missedJobs; // per task, skip and continue only
+    Histogram aperiodic;
+    long long aperiodicPending=0;
+    MonteCarloTotals(size_t tasks):firstMisses(tasks),response(tasks),jobs(tasks),missedJobs(tasks){}
+    void add(const SimResult& r,const RunMetrics& m){
+        runs++;
+        if(r.missed){
+            missedRuns++;
+            for(size_t i=0;i<m.ids.size();i++)
+                if(m.ids[i]==r.missId)firstMisses[i]++;
+        }
+        for(size_t i=0;i<m.tasks.size();i++)response[i].merge(m.tasks[i].response);
+        for(size_t i=0;i<r.overload.size();i++){
+            jobs[i]+=r.overload[i].jobs;
+            missedJobs[i]+=r.overload[i].missed;
+        }
+        aperiodic.merge(m.aperiodic);
+        aperiodicPending+=r.aperiodicPending;
+    }
+    void merge(const MonteCarloTotals& o){
+        runs+=o.runs;
+        missedRuns+=o.missedRuns;
+        for(size_t i=0;i<response.size();i++){
+            firstMisses[i]+=o.firstMisses[i];
+            response[i].merge(o.response[i]);
+            jobs[i]+=o.jobs[i];
+            missedJobs[i]+=o.missedJobs[i];
         }
+        aperiodic.merge(o.aperiodic);
+        aperiodicPending+=o.aperiodicPending;
     }
-    cout<<"Successfully scheduled until hyperperiod.\n";
+};
+
+void printDistribution(const Histogram& h){
+    cout<<"min "<<h.min()<<", mean "<<fixed<<setprecision(2)<<h.mean()<<defaultfloat<<", p50 "<<h.percentile(50)
+        <<", p95 "<<h.percentile(95)<<", p99 "<<h.percentile(99)<<", max "<<h.max();
 }
 
-void deferrableServer(vector<Task> &tasks,vector<Task> &aperiodicTasks,int choose,Server& df){
-    //1 for rm 2 for dm 3 for edf 4 for llf
-    if(choose!=1 && choose!=2 && choose!=3 && choose!=4){
-        cout<<"Unknown scheduling for periodics";
-        return;
+void monteCarlo(const vector<Task>& tasks,ArrivalSource& arrivals,int choose,const string& serverType,
+                const Server* server,const RunOptions& opts,const PreemptionModel& model,
+                const JobVariation& variation,const vector<DeclaredServer>* declared){
+    // the runs share the aperiodic jobs, loaded once
+    vector<Task> aperiodic;
+    arrivals.rewind();
+    for(AperiodicJob a;arrivals.next(a);){
+        aperiodic.push_back(Task(arrivals.name(a.id),a.release,a.remaining));
+        aperiodic.back().tag=arrivals.tag(a.id);
     }
-    if(!checkFeasibility(tasks)){
-        cout<<"This task set is not schedulable";
-        return;
+    const size_t CHUNK=64;
+    size_t runs=opts.monteCarlo,chunks=(runs+CHUNK-1)/CHUNK;
+    vector<MonteCarloTotals> chunkTotals(chunks,MonteCarloTotals(tasks.size()));
+    runPool(chunks,opts.threads,[&](size_t c){
+        SilentTrace sink;
+        JobVariation v=variation;
+        for(size_t k=c*CHUNK;k<min(runs,(c+1)*CHUNK);k++){
+            v.seed=variation.seed+k;
+            RunMetrics metrics;
+            SimResult r=simulate(tasks,aperiodic,choose,serverType,server,sink,false,&metrics,opts.onMiss,
+                                 model.active() || choose==6?&model:nullptr,opts.horizon,false,&v,declared);
+            chunkTotals[c].add(r,metrics);
+        }
+    });
+    MonteCarloTotals t(tasks.size());
+    for(const auto& c:chunkTotals)t.merge(c);
+
+    cout<<"Monte Carlo: "<<t.runs<<" runs, seeds "<<variation.seed<<" to "<<variation.seed+t.runs-1<<"\n";
+    // Wilson score interval, sound also for probabilities near 0 or 1
+    double n=t.runs,p=t.missedRuns/n,z=1.96;
+    double centre=(p+z*z/(2*n))/(1+z*z/n),half=z*sqrt(p*(1-p)/n+z*z/(4*n*n))/(1+z*z/n);
+    cout<<"Runs with a deadline miss: "<<t.missedRuns<<" of "<<t.runs<<", probability "<<fixed<<setprecision(4)<<p
+        <<" (95% interval "<<max(0.0,centre-half)<<" to "<<min(1.0,centre+half)<<")"<<defaultfloat<<"\n";
+    if(t.missedRuns){
+        cout<<"First misses:";
+        for(size_t i=0;i<tasks.size();i++) if(t.firstMisses[i])cout<<" "<<tasks[i].id<<" "<<t.firstMisses[i];
+        cout<<"\n";
+    }
+    cout<<"Response time from arrival, all runs:\n";
+    for(size_t i=0;i<tasks.size();i++){
+        cout<<tasks[i].id<<": "<<t.response[i].count()<<" jobs";
+        if(t.response[i].count()){
+            cout<<", ";
+            printDistribution(t.response[i]);
+        }
+        if(opts.onMiss!=MISS_ABORT && t.jobs[i])
+            cout<<", "<<t.missedJobs[i]<<" of "<<t.jobs[i]<<" missed (miss probability "<<fixed<<setprecision(4)
+                <<(double)t.missedJobs[i]/t.jobs[i]<<")"<<defaultfloat;
+        cout<<"\n";
+    }
+    if(!serverType.empty() || (declared && !declared->empty())){
+        cout<<"Aperiodic response time: ";
+        if(t.aperiodic.count())printDistribution(t.aperiodic);
+        else cout<<"none served";
+        cout<<" ("<<t.aperiodic.count()<<" served, "<<t.aperiodicPending<<" pending at the end of the runs)\n";
     }
+}
 
-    Task serverTask(df.ID,0,df.budget,df.period,df.period);
-    serverTask.isActive=true;
-    tasks.push_back(serverTask);
+// one "--name" or "--name=value" option into opts, false when a is not an option
+bool parseOption(const string& a,RunOptions& opts){
+    if(a=="--tick")opts.tickByTick=true;
+    else if(a=="--bench")opts.benchRuns=10;
+    else if(a.rfind("--bench=",0)==0)opts.benchRuns=max(1,atoi(a.c_str()+8));
+    else if(a=="--analyze-only")opts.analyzeOnly=true;
+    else if(a.rfind("--trace=",0)==0)opts.trace=a.substr(8);
+    else if(a.rfind("--out=",0)==0)opts.out=a.substr(6);
+    else if(a.rfind("--cores=",0)==0)opts.cores=atoi(a.c_str()+8);
+    else if(a.rfind("--partition=",0)==0)opts.partition=a.substr(12);
+    else if(a=="--batch")opts.batch=true;
+    else if(a=="--sensitivity")opts.sensitivity=true;
+    else if(a.rfind("--sweep=",0)==0)opts.sweep=a.substr(8);
+    else if(a.rfind("--threads=",0)==0)opts.threads=atoi(a.c_str()+10);
+    else if(a=="--on-miss=abort")opts.onMiss=MISS_ABORT;
+    else if(a=="--on-miss=skip")opts.onMiss=MISS_SKIP;
+    else if(a=="--on-miss=continue")opts.onMiss=MISS_CONTINUE;
+    else if(a=="--metrics")opts.metrics="-";
+    else if(a.rfind("--metrics=",0)==0)opts.metrics=a.substr(10);
+    else if(a.rfind("--switch-cost=",0)==0)opts.switchCost=max(0LL,atoll(a.c_str()+14));
+    else if(a.rfind("--crpd=",0)==0)opts.crpd=a.substr(7);
+    else if(a.rfind("--npr=",0)==0)opts.npr=a.substr(6);
+    else if(a=="--thresholds")opts.thresholds=true;
+    else if(a.rfind("--laxity-threshold=",0)==0)opts.laxityThreshold=min((long long)INT_MAX,max(0LL,atoll(a.c_str()+19)));
+    else if(a.rfind("--horizon=",0)==0)opts.horizon=max(0LL,atoll(a.c_str()+10));
+    else if(a=="--steady-state")opts.steadyState=true;
+    else if(a.rfind("--exec=",0)==0)opts.exec=a.substr(7);
+    else if(a.rfind("--sporadic=",0)==0)opts.sporadic=a.substr(11);
+    else if(a.rfind("--jitter=",0)==0)opts.jitter=a.substr(9);
+    else if(a.rfind("--seed=",0)==0)opts.seed=strtoull(a.c_str()+7,nullptr,10);
+    else if(a=="--monte-carlo")opts.monteCarlo=1000;
+    else if(a.rfind("--monte-carlo=",0)==0)opts.monteCarlo=max(1,atoi(a.c_str()+14));
+    else return false;
+    return true;
+}
 
-    for (auto &t : tasks) {
-        t.absolute_deadline = t.release_time + t.deadline_relative;
-        t.remaining_exec = t.exec_time;
-        t.isActive       = false;
-        if(choose==1)t.priority=1.0f/t.period;
-        else if(choose==2)t.priority=1.0f/t.deadline_relative; // as they are static priorities
-    }
+// ---------------- library interface ----------------
+// The C functions of rts.h. rts.exe is built without RTS_LIBRARY and keeps its main; the same
+// functions are in it, unused.
 
-    sortTasksByReleaseTime(aperiodicTasks);
-    for(auto &at: aperiodicTasks){
-        at.absolute_deadline=INT_MAX;
-        at.period=INT_MAX;
-        at.deadline_relative=INT_MAX;
-        at.isActive=false;
-        at.remaining_exec=at.exec_time;
-    }
+struct rts_sets{
+    vector<TaskSet> sets;
+};
 
-    int hyperperiod=calculate_hyperperiod(tasks);
-    int firstSimoultaneous=findFirstSimultaneousRelease(tasks);
-    vector<Task> currentTasks=tasks;
-    vector<Task> currentAperiodics=aperiodicTasks;
+static thread_local string libraryError;
 
-    for(int time=0; time<hyperperiod+firstSimoultaneous+1; time++){
-        for(auto &ct:currentTasks){
-            if(ct.id==df.ID)continue;
-            if(ct.absolute_deadline<=time){
-                cout<<"Deadline missed for "<< ct.id<<" at " <<time <<". Algorithm is failed.\n";
-                return;
-            }
-        }
-        for (auto &task : currentTasks) if(task.release_time<=time)task.isActive=true;
-        
-        if(time%df.period==0){
-            for(auto& t:currentTasks){
-                if(t.id==df.ID){
-                    t.remaining_exec=df.budget;
-                    t.release_time=time;
-                    t.absolute_deadline=time+df.period;
-                    break;
-                }
-            }
-        }
+static int libraryFail(const string& text){
+    libraryError=text;
+    return -1;
+}
 
-        if(choose==1 || choose==2) sortByExplicitPriority(currentTasks);
-        if(choose==3)sortByEarliestDeadline(currentTasks); // 3 and 4 are dynamic priorities
-        if(choose==4){
-            for (auto& task : currentTasks) task.priority = task.absolute_deadline - task.remaining_exec - time;
-            sortByLeastLaxity(currentTasks);
-        }
+// the intervals of a run handed to the caller's function, merged as in the csv trace
+struct CallbackTrace:IntervalTrace{
+    rts_segment_fn fn;
+    void* user;
+    CallbackTrace(rts_segment_fn fn,void* user):fn(fn),user(user){}
+    void emit(const Segment& s) override{
+        if(fn)fn(user,s.start,s.end,names.job(s).c_str(),s.overhead?RTS_SWITCH:(int)s.kind);
+    }
+    void warning(const string&) override{}
+};
 
+rts_sets* rts_load(const char* path){
+    unique_ptr<rts_sets> sets(new rts_sets);
+    if(!path || !loadBatchInput(path,sets->sets)){
+        libraryError=string("Cannot open ")+(path?path:"(null)");
+        return nullptr;
+    }
+    return sets.release();
+}
 
-        bool isThereAperiodicTask=false;
-        for(auto& task:currentAperiodics){
-            if(task.release_time<=time)isThereAperiodicTask=true;
-        }
+rts_sets* rts_parse(const char* text){
+    if(!text){
+        libraryError="No input text.";
+        return nullptr;
+    }
+    rts_sets* sets=new rts_sets;
+    parseTaskSets(text,text+strlen(text),"input","",sets->sets);
+    return sets;
+}
 
-        int runningTaskIndex=0;
-        for (auto &task : currentTasks){
-            if(task.isActive==false)runningTaskIndex++;
-            else{
-                if(task.id==df.ID && (task.remaining_exec==0 || !isThereAperiodicTask)){
-                    runningTaskIndex++;
-                }else break;
-            } 
-        }
-        
-        if(runningTaskIndex==currentTasks.size()){
-            cout<<"System is Idle at "<< time <<".\n";
-            continue;
-        }
+void rts_free(rts_sets* sets){ delete sets; }
 
-        Task& running=currentTasks[runningTaskIndex];
-        if(running.id==df.ID){
-            cout << "At time: " << time << " Server " << running.id 
-            << " serving " << currentAperiodics[0].id 
-            << " (budget: " << running.remaining_exec << ")\n";
+int rts_set_count(const rts_sets* sets){ return sets?sets->sets.size():0; }
 
-            running.remaining_exec--;
-            currentAperiodics[0].remaining_exec--; //if we have no ready aperiodic task server.remaining_exec will be 0 so runningtask index will never be here 
-            if(currentAperiodics[0].remaining_exec==0){
-                currentAperiodics.erase(currentAperiodics.begin());
-            }
-            continue;
-        }
+const char* rts_set_name(const rts_sets* sets,int index){
+    if(!sets || index<0 || index>=(int)sets->sets.size())return "";
+    return sets->sets[index].name.c_str();
+}
 
-        cout<<"At time: "<< time<<" Task" << currentTasks[runningTaskIndex].id<<" is running\n";
+const char* rts_error(void){ return libraryError.c_str(); }
 
-        currentTasks[runningTaskIndex].remaining_exec--;
-        if(currentTasks[runningTaskIndex].remaining_exec==0){
-            Task oldTask=currentTasks[runningTaskIndex];
-            Task newTask=oldTask;
-            
-            newTask.isActive=false;
-            newTask.release_time=oldTask.release_time+oldTask.period;
-            newTask.absolute_deadline=newTask.release_time+newTask.deadline_relative;
-            newTask.remaining_exec=newTask.exec_time;
+int rts_run(const rts_sets* sets,int index,const char* algorithm,const char* server,
+            long long budget,long long period,const char* options,
+            rts_segment_fn segment,void* user,rts_result* result){
+    if(!sets || index<0 || index>=(int)sets->sets.size())return libraryFail("No task set "+to_string(index)+".");
+    const TaskSet& set=sets->sets[index];
+    RunOptions opts;
+    stringstream words(options?options:"");
+    for(string word;words>>word;)
+        if(!parseOption(word,opts))return libraryFail("Unknown option "+word+".");
+    if(opts.batch || opts.sensitivity || !opts.sweep.empty() || opts.monteCarlo>0 || opts.benchRuns>0
+       || opts.analyzeOnly || opts.cores>1
+       || !opts.metrics.empty() || !opts.out.empty() || opts.trace!="text")
+        return libraryFail("Only the options of a single core simulation apply to rts_run.");
+    if(!opts.npr.empty() && opts.thresholds)return libraryFail("Use either --npr or --thresholds.");
+    int choose=getAlgorithmCode(algorithm?algorithm:"");
+    if(choose==0)return libraryFail(string("Unknown algorithm ")+(algorithm?algorithm:"(null)")+".");
+    string name=server?server:"";
+    string type=getServerType(name);
+    if(type.empty() && !name.empty() && name!="none")return libraryFail("Wrong server type "+name+".");
+    if(budgetedServer(type) && (budget<=0 || period<=0))return libraryFail(type+" needs a budget and a period.");
+    if(const char* mismatch=serverMismatch(choose,type))return libraryFail(mismatch);
+    PreemptionModel model;
+    string error,note;
+    if(!preemptionModel(set.periodic,choose,opts,model,error,note))return libraryFail(error);
+    JobVariation variation;
+    if(!jobVariation(set.periodic,opts,opts.seed,variation,error))return libraryFail(error);
+    if(variation.active() && opts.steadyState)return libraryFail("Random jobs do not repeat, leave out --steady-state.");
+    Server s("ServerTask",period,budget);
+    const Server* sp=budgetedServer(type)?&s:nullptr;
+    bool declared=!set.servers.empty();
+    if(declared){
+        if(!type.empty())return libraryFail("The task set declares its servers (S lines), pass no server.");
+        if(!serverClasses(set.aperiodic,set.servers,choose,error))return libraryFail(error);
+    }
+    bool fits=declared?hyperperiodFits(withServerTasks(set.periodic,set.servers),nullptr)
+                      :hyperperiodFits(set.periodic,sp);
+    if(!opts.horizon && !fits)
+        return libraryFail("The hyperperiod exceeds 64-bit time, simulate a bounded horizon with --horizon=T.");
 
-            currentTasks.erase(currentTasks.begin()+runningTaskIndex);
-            currentTasks.push_back(newTask);
-        }
+    VectorArrivals arrivals(set.aperiodic); // outlives the run, the last interval is named after it
+    CallbackTrace trace(segment,user);
+    SimResult r=simulate(set.periodic,arrivals,choose,type,sp,trace,opts.tickByTick,nullptr,opts.onMiss,
+                         model.active() || choose==6?&model:nullptr,opts.horizon,opts.steadyState,&variation,
+                         declared?&set.servers:nullptr);
+    trace.finish();
+    if(result){
+        *result=rts_result();
+        result->missed=r.missed;
+        snprintf(result->miss_id,sizeof result->miss_id,"%s",r.missId.c_str());
+        result->miss_time=r.missTime;
+        result->simulated_until=r.simulatedUntil;
+        result->bounded=r.bounded;
+        result->segments=r.segments;
+        result->preemptions=r.preemptions;
+        result->aperiodic_served=r.aperiodicResponse.size();
+        result->aperiodic_pending=r.aperiodicPending;
+        ResponseStats st=responseStats(r.aperiodicResponse);
+        result->aperiodic_mean_response=st.mean;
+        result->aperiodic_p95_response=st.p95;
+        result->aperiodic_max_response=st.max;
+        result->cycle_start=r.cycleStart;
+        result->cycle_length=r.cycleLength;
     }
-    cout<<"Successfully scheduled until hyperperiod.\n";
+    return 0;
 }
 
+#ifndef RTS_LIBRARY
 int main(int argc, char* argv[]){
+    // options start with "--" and may appear anywhere, the rest are positional
+    RunOptions opts;
+    vector<string> args;
+    for(int i=0;i<argc;i++){
+        string a=argv[i];
+        if(a=="--cores" && i+1<argc)opts.cores=atoi(argv[++i]);
+        else if(a.rfind("--",0)==0 && !parseOption(a,opts)){
+            cerr << "Unknown option " << a << "." << endl;
+            return 1;
+        }
+        else if(a.rfind("--",0)!=0)args.push_back(a);
+    }
+    argc=args.size();
+
     if (argc < 3) {
         cerr << "Wrong Argument Count!" << endl;
         return 1;
     }
-    string filename = argv[1];
-    string algoStr = argv[2];
+    if (!opts.npr.empty() && opts.thresholds) {
+        cerr << "Use either --npr or --thresholds." << endl;
+        return 1;
+    }
+    if (opts.cores > 1 && opts.limitsPreemption()) {
+        cerr << "Context switch costs and limited preemption are single core only." << endl;
+        return 1;
+    }
+    if (opts.cores > 1 && opts.steadyState) {
+        cerr << "Steady state detection is single core only." << endl;
+        return 1;
+    }
+    if ((opts.randomJobs() || opts.monteCarlo > 0)
+        && (opts.cores > 1 || opts.batch || opts.sensitivity || !opts.sweep.empty() || opts.steadyState)) {
+        cerr << "Random jobs (--exec, --sporadic, --jitter) are single core and not for --batch, --sensitivity,"
+                " --sweep or --steady-state." << endl;
+        return 1;
+    }
+    if (opts.monteCarlo > 0 && (!opts.randomJobs() || opts.trace != "text" || !opts.out.empty()
+                                || !opts.metrics.empty() || opts.benchRuns > 0)) {
+        cerr << "--monte-carlo needs random jobs (--exec, --sporadic or --jitter) and prints a summary only"
+                " (no --trace, --out, --metrics or --bench)." << endl;
+        return 1;
+    }
+    if (opts.sensitivity && (opts.batch || opts.cores > 1 || opts.limitsPreemption())) {
+        cerr << "Sensitivity analysis is single core with free preemption, and not a batch run." << endl;
+        return 1;
+    }
+    if (!opts.sweep.empty() && (opts.batch || opts.sensitivity || opts.cores > 1 || !opts.metrics.empty())) {
+        cerr << "The server sweep is single core, without --batch, --sensitivity or --metrics." << endl;
+        return 1;
+    }
+    if (opts.batch || opts.sensitivity || !opts.sweep.empty()) {
+        // rts.exe <directory|file> rm,edf [none,bg,poller:1:4,ds:1:4] --batch [--threads=N] [--out=path]
+        // the same with --sensitivity for the critical scaling factors, and
+        // rts.exe <directory|file> rm,edf [poller,ds] --sweep=PMIN:PMAX for the server front
+        if (argc > 4) {
+            cerr << "Wrong Argument Count!" << endl;
+            return 1;
+        }
+        if (opts.metrics == "-") {
+            cerr << "Batch metrics need a file (--metrics=path)." << endl;
+            return 1;
+        }
+        ofstream file;
+        if (!opts.out.empty()) {
+            file.open(opts.out);
+            if (!file) {
+                cerr << "Cannot open output file " << opts.out << endl;
+                return 1;
+            }
+        }
+        if (!opts.sweep.empty())
+            return runSweep(args[1], args[2], argc == 4 ? args[3] : "poller,ds", opts,
+                            opts.out.empty() ? cout : file);
+        if (opts.sensitivity)
+            return runSensitivity(args[1], args[2], argc == 4 ? args[3] : "none", opts,
+                                  opts.out.empty() ? cout : file);
+        return runBatch(args[1], args[2], argc == 4 ? args[3] : "none", opts,
+                        opts.out.empty() ? cout : file);
+    }
+    if (opts.trace != "text" && opts.trace != "csv" && opts.trace != "bin") {
+        cerr << "Wrong trace format (Only text, csv, bin)." << endl;
+        return 1;
+    }
+    if (opts.cores < 1 || (opts.partition != "" && opts.partition != "ff" && opts.partition != "wfd")) {
+        cerr << "Wrong multiprocessor option (--cores=M with M>=1, --partition=ff or wfd)." << endl;
+        return 1;
+    }
+    if (opts.cores > 1 && opts.trace == "bin") {
+        cerr << "Binary trace is single core only, use --trace=csv with --cores." << endl;
+        return 1;
+    }
+    if (opts.cores > 1 && !opts.metrics.empty()) {
+        cerr << "Metrics are single core only." << endl;
+        return 1;
+    }
+    if (opts.cores > 1 && opts.partition.empty() && argc > 3) {
+        cerr << "Servers need partitioned scheduling (--partition=ff or wfd) with --cores." << endl;
+        return 1;
+    }
+    if (opts.trace == "bin" && opts.out.empty()) {
+        cerr << "Binary trace needs an output file (--out=path)." << endl;
+        return 1;
+    }
+    string filename = args[1];
+    string algoStr = args[2];
+    opts.input = filename;
     int algoCode = getAlgorithmCode(algoStr);
 
     if (algoCode == 0) {
-        cerr << "Wrong scheduling algorithm (Only RM, DM, EDF, LLF)." << endl;
+        cerr << "Wrong scheduling algorithm (Only RM, DM, EDF, LLF, OPA, ELLF)." << endl;
+        return 1;
+    }
+    if (algoCode == 5 && opts.cores > 1 && opts.partition.empty()) {
+        cerr << "OPA needs partitioned scheduling (--partition=ff or wfd) with --cores." << endl;
+        return 1;
+    }
+    if (algoCode == 6 && opts.cores > 1) {
+        cerr << "ELLF is single core only." << endl;
         return 1;
     }
 
     vector<Task> periodicTasks;
     vector<Task> aperiodicTasks;
-    readInputFile(filename, periodicTasks, aperiodicTasks);
+    vector<DeclaredServer> servers;
+    unique_ptr<ArrivalSource> arrivals = readInputFile(filename, periodicTasks, aperiodicTasks, servers);
+
+    if (!servers.empty() && argc > 3) {
+        cerr << "The input declares its servers (S lines), leave out the server argument." << endl;
+        return 1;
+    }
+    if (!servers.empty() && opts.cores > 1) {
+        cerr << "Declared servers (S lines) are single core." << endl;
+        return 1;
+    }
 
     if (argc == 3) {
         cout << "Running Periodic Scheduling: " << algoStr << endl;
-        if (algoCode == 1) rateMonotonic(periodicTasks);
-        else if (algoCode == 2) deadlineMonotonic(periodicTasks);
-        else if (algoCode == 3) earliestDeadlineFirst(periodicTasks);
-        else if (algoCode == 4) leastLaxityFirst(periodicTasks);
+        schedule(periodicTasks, *arrivals, algoCode, "", nullptr, opts, servers, aperiodicTasks);
     }
     else {
-        string serverType = getServerType(argv[3]);
+        string serverType = getServerType(args[3]);
 
         if (serverType == "BG") {
-            backgroundServer(periodicTasks, aperiodicTasks, algoCode);
+            schedule(periodicTasks, *arrivals, algoCode, serverType, nullptr, opts, servers, aperiodicTasks);
         }
-        else if (serverType == "POLLER" || serverType == "DS") {            
+        else if (budgetedServer(serverType)) {
             if (argc != 6) {
                 cerr << "Wrong format: " << serverType << " Need budget and Period" << endl;
                 return 1;
             }
-            int budget = stoi(argv[4]);
-            int period = stoi(argv[5]);
-            Server sObj("ServerTask", period, budget);
-
-            if (serverType == "POLLER") {
-                pollerServer(periodicTasks, aperiodicTasks, algoCode, sObj);
-            } else {
-                deferrableServer(periodicTasks, aperiodicTasks, algoCode, sObj);
+            long long budget = stoll(args[4]);
+            long long period = stoll(args[5]);
+            if (budget <= 0 || period <= 0) {
+                cerr << "Wrong format: " << serverType << " Need budget and Period" << endl;
+                return 1;
             }
+            Server sObj("ServerTask", period, budget);
+            schedule(periodicTasks, *arrivals, algoCode, serverType, &sObj, opts, servers, aperiodicTasks);
         }
         else {
-            cerr << "Wrong server type.(Only BG,DS,POLLING)" << argv[3] << endl;
+            cerr << "Wrong server type.(Only BG,DS,POLLING,SS,TBS,CBS)" << args[3] << endl;
             return 1;
         }
     }
     return 0;
 }
+#endif
 
-void sortTasksByReleaseTime(vector<Task>& tasks) {
-    std::sort(tasks.begin(), tasks.end(), [](const Task& a, const Task& b) {
-        return a.release_time < b.release_time;
-    });
-}
-
-void sortByLeastLaxity(vector<Task>& tasks) {
-    sort(tasks.begin(), tasks.end(), [](const Task& a, const Task& b) {
-        if (!a.isActive && b.isActive) return false;
-        if (a.isActive && !b.isActive) return true;
-        if (!a.isActive && !b.isActive) return false;
-        
-        return a.priority < b.priority;
-    });
-}
-
-void sortByEarliestDeadline(vector<Task>& tasks) {
-    sort(tasks.begin(), tasks.end(), [](const Task& a, const Task& b) {
-        if (!a.isActive && b.isActive) return false;
-        if (a.isActive && !b.isActive) return true;
-        if (!a.isActive && !b.isActive) return false;
-        return a.absolute_deadline < b.absolute_deadline;
-    });
-}
-
-void sortByExplicitPriority(vector<Task>& tasks) {
-    sort(tasks.begin(), tasks.end(), [](const Task& a, const Task& b) {
-        return a.priority > b.priority; 
-    });
-}
 bool checkFeasibility(vector<Task>& tasks){
     double u = 0.0;
     for(const auto& task:tasks){
@@ -692,7 +4342,7 @@ bool checkFeasibility(vector<Task>& tasks){
     if (u>1)return false;
     return true;
 }
-int gcd(int a, int b) {
+long long gcd(long long a, long long b) {
     while (b) {
         a %= b;
         swap(a, b);
@@ -700,47 +4350,88 @@ int gcd(int a, int b) {
     return a;
 }
 
-int lcm(int a, int b) {
-    if (a == 0 || b == 0) return 0;
-    return (a * b) / gcd(a, b);
+// -1 when the result does not fit in 64 bits or a value is not positive
+long long lcm(long long a, long long b) {
+    if (a <= 0 || b <= 0) return -1;
+    long long g = gcd(a, b);
+    if (a / g > LLONG_MAX / b) return -1;
+    return a / g * b;
 }
 
-int calculate_hyperperiod(const std::vector<Task>& tasks) {
-    int hyperperiod = 1;
+// -1 when the hyperperiod does not fit in 64 bits
+long long calculate_hyperperiod(const std::vector<Task>& tasks) {
+    long long hyperperiod = 1;
     for (const auto& task : tasks) {
         hyperperiod = lcm(hyperperiod, task.period);
+        if (hyperperiod < 0) return -1;
     }
     return hyperperiod;
 }
 
-int findFirstSimultaneousRelease(const std::vector<Task>& tasks) {
+// x with (a*x) % m == 1 for gcd(a,m)==1, by the extended Euclidean algorithm
+static long long modInverse(long long a, long long m) {
+    long long old_r = a % m, r = m, old_s = 1, s = 0;
+    while (r) {
+        long long q = old_r / r;
+        old_r -= q * r; swap(old_r, r);
+        old_s -= q * s; swap(old_s, s);
+    }
+    old_s %= m;
+    return old_s < 0 ? old_s + m : old_s;
+}
+
+// Smallest time at or after every first release where all tasks release together. The releases
+// r_i + k*p_i are congruences t = r_i (mod p_i), merged pairwise with the Chinese remainder theorem:
+// t = x (mod m) and t = r (mod p) have a common solution iff (r-x) is divisible by g = gcd(m,p), and then
+// t = x + m*k with k = ((r-x)/g) * inv(m/g) (mod p/g), modulus lcm(m,p). -1 when a value overflows 64 bits or a period is not positive.
+long long findFirstSimultaneousRelease(const std::vector<Task>& tasks,string* warning) {
     if (tasks.empty()) return -1;
+    for (const auto& task : tasks)
+        if (task.period <= 0) return -1;
 
-    long long current_time = tasks[0].release_time;
-    long long current_step = tasks[0].period;
+    long long x = tasks[0].release_time % tasks[0].period;
+    long long m = tasks[0].period;
+    long long latest = tasks[0].release_time;
 
     for (size_t i = 1; i < tasks.size(); ++i) {
-        int r_next = tasks[i].release_time;
-        int p_next = tasks[i].period;
+        long long r = tasks[i].release_time % tasks[i].period;
+        long long p = tasks[i].period;
+        latest = max(latest, tasks[i].release_time);
 
-        if ((r_next - current_time) % gcd(current_step, p_next) != 0) {
-            std::cerr << "Warning: Task " << tasks[0].id << " Task " << tasks[i].id 
-                      << "never release at the same time. So will be simulated only until hyperperiod" << std::endl;
+        long long g = gcd(m, p);
+        long long diff = r - x;
+        if (diff % g != 0) {
+            string text = "Warning: Task " + tasks[0].id + " Task " + tasks[i].id
+                        + "never release at the same time. So will be simulated only until hyperperiod";
+            if (warning) *warning = text;
+            else std::cerr << text << std::endl;
             return 0; 
         }
-        while (true) {
-            long long relative_time = current_time - r_next;
-            
-            if (relative_time >= 0 && relative_time % p_next == 0) {
-                break;
-            }
-            
-            current_time += current_step;
-        }
-        current_step = lcm(current_step, p_next);
+        long long step = p / g;
+        long long k = (long long)((WideTime)(diff / g % step + step) % step * modInverse(m / g % step, step) % step);
+        long long merged = lcm(m, p);
+        if (merged < 0) return -1;
+        x = (long long)(((WideTime)x + (WideTime)m * k) % merged);
+        m = merged;
+    }
+
+    // lift the residue to the first solution that no task releases before
+    if (x < latest) {
+        long long periods = (latest - x + m - 1) / m;
+        if (periods > (LLONG_MAX - x) / m) return -1;
+        x += periods * m;
     }
+    return x;
+}
 
-    return current_time;
+// The simulated span: the first simultaneous release plus one hyperperiod, plus one (the last unit is checked too).
+// -1 when that does not fit in 64 bits, --horizon then has to bound the run.
+long long simulationEnd(const vector<Task>& tasks,string* warning){
+    if(tasks.empty())return 1; // nothing is released, a single idle unit
+    long long hyper=calculate_hyperperiod(tasks);
+    long long first=findFirstSimultaneousRelease(tasks,warning);
+    if(hyper<0 || first<0 || first>LLONG_MAX-1-hyper)return -1;
+    return hyper+first+1;
 }
 
 
@@ -750,6 +4441,9 @@ string getServerType(string s) {
     if (s == "BACKGROUND" || s == "BG") return "BG";
     if (s == "POLLER" || s == "POLLING") return "POLLER";
     if (s == "DEFERRABLE" || s == "DS") return "DS";
+    if (s == "SPORADIC" || s == "SS") return "SS";
+    if (s == "TOTALBANDWIDTH" || s == "TBS") return "TBS";
+    if (s == "CONSTANTBANDWIDTH" || s == "CBS") return "CBS";
     return "";
 }
 
@@ -760,92 +4454,174 @@ int getAlgorithmCode(string algo) {
     if (algo == "DM") return 2;
     if (algo == "EDF") return 3;
     if (algo == "LLF") return 4;
+    if (algo == "OPA") return 5;
+    if (algo == "ELLF") return 6;
     
     return 0; 
 }
 
-void readInputFile(const string& filename, vector<Task>& periodicTasks, vector<Task>& aperiodicTasks) {
-    ifstream file(filename);
-    if (!file.is_open()) {
-        cerr << "Error: " << filename << " file could not be opened!" << endl;
-        return;
-    }
-
-    string line;
-    int p_counter = 1; 
-    int a_counter = 1; 
+// release, execution time and period of a P/D line; a period of 0 would divide by zero later
+static bool validTaskValues(long long release, long long exec, long long period) {
+    return release >= 0 && exec >= 0 && period > 0;
+}
 
-    while (getline(file, line)) {
-        if (line.empty() || line[0] == '#') continue;
+// one P/D/A/S line of an input file; ids count up per set, errors go to err
+bool parseTaskLine(const TaskLine& line, vector<Task>& periodicTasks, vector<Task>& aperiodicTasks,
+                   vector<DeclaredServer>& servers, int& p_counter, int& a_counter, ostream& err) {
+    char type = line.type;
+    const long long* values = line.values;
 
-        stringstream ss(line);
-        string type;
-        ss >> type; 
+    if (type == 'P') {
+        string id = "T" + to_string(p_counter++);
+        long long r, e, p, d;
 
-        vector<int> values;
-        int val;
-        while (ss >> val) {
-            values.push_back(val);
+        if (line.count == 4) {
+            r = values[0];
+            e = values[1];
+            p = values[2];
+            d = values[3];
         }
-
-        if (type == "P") {
+        else if (line.count == 3) {
+            r = values[0];
+            e = values[1];
+            p = values[2];
+            d = p; 
+        }
+        else if (line.count == 2) {
+            r = 0;
+            e = values[0];
+            p = values[1];
+            d = p;
+        } else {
+            err << "wrong format: " << line.text() << endl;
+            return false;
+        }
+        if (!validTaskValues(r, e, p)) {
+            err << "wrong format: " << line.text() << endl;
+            return false;
+        }
+        
+        periodicTasks.emplace_back(id, r, e, p, d);
+    }
+    
+    else if (type == 'D') {
+        if (line.count == 3) {
             string id = "T" + to_string(p_counter++);
-            int r, e, p, d;
-
-            if (values.size() == 4) {
-                r = values[0];
-                e = values[1];
-                p = values[2];
-                d = values[3];
-            }
-            else if (values.size() == 3) {
-                r = values[0];
-                e = values[1];
-                p = values[2];
-                d = p; 
-            }
-            else if (values.size() == 2) {
-                r = 0;
-                e = values[0];
-                p = values[1];
-                d = p;
-            } else {
-                cerr << "wrong format: " << line << endl;
-                continue;
+            long long r = 0;
+            long long e = values[0];
+            long long p = values[1];
+            long long d = values[2];
+            if (!validTaskValues(r, e, p)) {
+                err << "wrong format: " << line.text() << endl;
+                return false;
             }
-            
+
             periodicTasks.emplace_back(id, r, e, p, d);
+        } else {
+            err << "wrong format: " << line.text() << endl;
+            return false;
         }
-        
-        else if (type == "D") {
-            if (values.size() == 3) {
-                string id = "T" + to_string(p_counter++);
-                int r = 0;
-                int e = values[0];
-                int p = values[1];
-                int d = values[2];
+    }
 
-                periodicTasks.emplace_back(id, r, e, p, d);
-            } else {
-                cerr << "wrong format: " << line << endl;
-            }
+    else if (type == 'A') {
+        if (line.count == 2) {
+            string id = "A" + to_string(a_counter++);
+            long long r = values[0];
+            long long e = values[1];
+            
+            aperiodicTasks.emplace_back(id, r, e, INT_MAX, INT_MAX);
+            aperiodicTasks.back().tag.assign(line.word, line.wordLength);
+        } else {
+            err << "wrong format: " << line.text() << endl;
+            return false;
+        }
+    }
+
+    else if (type == 'S') {
+        // S name type [budget period]
+        stringstream ss(line.text());
+        string letter, extra;
+        DeclaredServer s;
+        ss >> letter >> s.name >> s.type;
+        s.type = getServerType(s.type);
+        bool budgeted = budgetedServer(s.type);
+        if (budgeted) ss >> s.budget >> s.period;
+        bool duplicate = false;
+        for (const auto& other : servers) duplicate = duplicate || other.name == s.name;
+        if (s.type.empty() || duplicate || !ss || (ss >> extra)
+            || (budgeted && (s.budget <= 0 || s.period <= 0))) {
+            err << "wrong format: " << line.text() << endl;
+            return false;
         }
+        servers.push_back(s);
+    }
+    return true;
+}
 
-        else if (type == "A") {
-            if (values.size() == 2) {
-                string id = "A" + to_string(a_counter++);
-                int r = values[0];
-                int e = values[1];
-                
-                aperiodicTasks.emplace_back(id, r, e, INT_MAX, INT_MAX);
-            } else {
-                cerr << "wrong format: " << line << endl;
-            }
+// One pass over a task file: periodic tasks are built, A lines only counted and checked for
+// release order. Errors go to err.
+void scanInput(const MappedFile& input, vector<Task>& periodicTasks, vector<DeclaredServer>& servers,
+               size_t& aperiodicCount, bool& ordered, ostream& err) {
+    int p_counter = 1;
+    int a_counter = 1;
+    long long lastRelease = LLONG_MIN;
+    vector<Task> unused;
+    aperiodicCount = 0;
+    ordered = true;
+
+    const char* p = input.begin();
+    TaskLine line;
+    while (nextLine(p, input.end(), line)) {
+        if (line.type == 'A' && line.count == 2) {
+            if (line.values[0] < lastRelease) ordered = false;
+            lastRelease = line.values[0];
+            aperiodicCount++;
+            a_counter++;
+            continue;
         }
+        if (line.type != 0) parseTaskLine(line, periodicTasks, unused, servers, p_counter, a_counter, err);
+    }
+}
+
+// Periodic tasks and declared servers are loaded. Aperiodic arrivals stay in the mapped file and are
+// scanned while simulating when the file lists them in release order and declares no servers;
+// otherwise they are loaded into aperiodicTasks, with their classes.
+unique_ptr<ArrivalSource> readInputFile(const string& filename, vector<Task>& periodicTasks, vector<Task>& aperiodicTasks,
+                                        vector<DeclaredServer>& servers) {
+    shared_ptr<MappedFile> input(new MappedFile(filename));
+    if (!input->isOpen()) {
+        cerr << "Error: " << filename << " file could not be opened!" << endl;
+        return unique_ptr<ArrivalSource>(new VectorArrivals(aperiodicTasks));
     }
 
-    file.close();
+    size_t aperiodicCount = 0;
+    bool ordered = true;
+    scanInput(*input, periodicTasks, servers, aperiodicCount, ordered, cerr);
+
+    unique_ptr<ArrivalSource> arrivals(new FileArrivals(input, aperiodicCount));
+    if (!servers.empty()) {
+        // the class tags are only on the lines
+        const char* p = input->begin();
+        TaskLine line;
+        vector<Task> unused;
+        vector<DeclaredServer> known;
+        int p_counter = 1, a_counter = 1;
+        ostringstream reported;
+        while (nextLine(p, input->end(), line))
+            if (line.type == 'A' && line.count == 2)
+                parseTaskLine(line, unused, aperiodicTasks, known, p_counter, a_counter, reported);
+        arrivals.reset(new VectorArrivals(aperiodicTasks));
+    }
+    else if (!ordered) {
+        AperiodicJob j;
+        arrivals->rewind();
+        while (arrivals->next(j)) aperiodicTasks.emplace_back(arrivals->name(j.id), j.release, j.remaining, INT_MAX, INT_MAX);
+        arrivals.reset(new VectorArrivals(aperiodicTasks));
+    }
     cout << filename << " file read succesfully. ";
     cout << "Periodic Task Count: " << periodicTasks.size();
-    cout << "Aperiodic Task Count: " << aperiodicTasks.size() << endl;
-}
\ No newline at end of file
+    cout << "Aperiodic Task Count: " << aperiodicCount;
+    if (!servers.empty()) cout << "Declared Server Count: " << servers.size();
+    cout << endl;
+    return arrivals;
+}
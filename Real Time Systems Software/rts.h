@@ -0,0 +1,119 @@
+/*
+ * librts: the scheduler of rts.cpp as a library, for tools that run many configurations and
+ * would otherwise start rts.exe and parse its output every time.
+ *
+ *   g++ -O2 -shared -fPIC -pthread -DRTS_LIBRARY -o librts.so rts.cpp     (rts.dll on Windows)
+ *
+ * The C functions below are the ABI (rts.py binds them with ctypes); rts::TaskSets at the end
+ * is the same for C++ callers. A run reports the schedule through a callback, one call per
+ * interval of the running job (the --trace=csv rows), and fills an rts_result.
+ * Calls on the same rts_sets may run from several threads at once.
+ */
+#ifndef RTS_H
+#define RTS_H
+
+#if defined(_WIN32) && defined(RTS_LIBRARY)
+#define RTS_API __declspec(dllexport)
+#else
+#define RTS_API
+#endif
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* interval kinds, as in the binary trace */
+enum { RTS_IDLE=0, RTS_TASK=1, RTS_SERVER=2, RTS_APERIODIC=3, RTS_SWITCH=4 };
+
+typedef struct rts_sets rts_sets;
+
+typedef struct rts_result{
+    int missed;                      /* a deadline was missed */
+    char miss_id[32];                /* the task that missed first */
+    long long miss_time;
+    long long simulated_until;
+    int bounded;                     /* the horizon ended the run before the hyperperiod */
+    long long segments;              /* scheduling decisions */
+    long long preemptions;
+    long long aperiodic_served;
+    long long aperiodic_pending;
+    double aperiodic_mean_response;
+    long long aperiodic_p95_response;
+    long long aperiodic_max_response;
+    long long cycle_start;           /* --steady-state: the schedule repeats from here, */
+    long long cycle_length;          /* every cycle_length time units (0: no cycle found) */
+} rts_result;
+
+/* start, end (exclusive), job id ("" while idle) and kind of one interval */
+typedef void (*rts_segment_fn)(void* user,long long start,long long end,const char* job,int kind);
+
+/* the task sets of an input file or directory ("SET name" lines start more than one), NULL on error */
+RTS_API rts_sets* rts_load(const char* path);
+/* the same from the contents of an input file */
+RTS_API rts_sets* rts_parse(const char* text);
+RTS_API void rts_free(rts_sets* sets);
+RTS_API int rts_set_count(const rts_sets* sets);
+RTS_API const char* rts_set_name(const rts_sets* sets,int index);
+
+/*
+ * Simulates task set index. algorithm: rm, dm, edf, llf, opa or ellf. server: NULL, "" or "none"
+ * for no server, else any server name of the command line (budget and period are ignored for
+ * background). options: the command line options of a single core run separated by spaces, e.g.
+ * "--on-miss=continue --switch-cost=1 --horizon=1000 --steady-state" or "--exec=uniform:50 --seed=7".
+ * segment may be NULL.
+ * 0 on success, -1 on error (see rts_error).
+ */
+RTS_API int rts_run(const rts_sets* sets,int index,const char* algorithm,const char* server,
+                    long long budget,long long period,const char* options,
+                    rts_segment_fn segment,void* user,rts_result* result);
+
+/* why the last call of this thread failed */
+RTS_API const char* rts_error(void);
+
+#ifdef __cplusplus
+}
+
+#include <functional>
+#include <string>
+
+namespace rts{
+
+struct Interval{
+    long long start;
+    long long end;
+    std::string job;
+    int kind;
+};
+
+class TaskSets{
+public:
+    // false on error, rts_error() says why
+    bool load(const std::string& path){ reset(rts_load(path.c_str())); return sets!=nullptr; }
+    bool parse(const std::string& text){ reset(rts_parse(text.c_str())); return sets!=nullptr; }
+    int size() const { return sets?rts_set_count(sets):0; }
+    std::string name(int index) const { return rts_set_name(sets,index); }
+    bool run(int index,const std::string& algorithm,const std::string& server,long long budget,long long period,
+             const std::string& options,const std::function<void(const Interval&)>& segment,
+             rts_result& result) const{
+        rts_segment_fn forward=[](void* user,long long start,long long end,const char* job,int kind){
+            (*(const std::function<void(const Interval&)>*)user)(Interval{start,end,job,kind});
+        };
+        return rts_run(sets,index,algorithm.c_str(),server.c_str(),budget,period,options.c_str(),
+                       segment?forward:nullptr,(void*)&segment,&result)==0;
+    }
+    TaskSets()=default;
+    TaskSets(const TaskSets&)=delete;
+    TaskSets& operator=(const TaskSets&)=delete;
+    ~TaskSets(){ reset(nullptr); }
+private:
+    rts_sets* sets=nullptr;
+    void reset(rts_sets* s){
+        if(sets)rts_free(sets);
+        sets=s;
+    }
+};
+
+}
+#endif
+
+#endif
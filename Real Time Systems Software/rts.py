@@ -0,0 +1,141 @@
+"""
+librts için ctypes bağlaması: rts.exe'yi her seferinde başlatıp çıktısını parse etmek yerine
+scheduler aynı process içinde çalışır.
+
+Kütüphane (rts.h'ye bakın):
+  g++ -O2 -shared -fPIC -pthread -DRTS_LIBRARY -o librts.so rts.cpp   (Windows: rts.dll)
+
+Örnek:
+  import rts
+  lib = rts.Library()                      # librts.so / rts.dll bu dosyanın yanında aranır
+  sets = lib.load("inputs.txt")
+  result, intervals = sets.run(0, "rm", "deferrable", 1, 3)
+"""
+import ctypes
+import os
+import sys
+
+IDLE, TASK, SERVER, APERIODIC, SWITCH = range(5)
+KIND_NAMES = {IDLE: "idle", TASK: "task", SERVER: "server", APERIODIC: "aperiodic", SWITCH: "switch"}
+
+
+class Result(ctypes.Structure):
+    _fields_ = [
+        ("missed", ctypes.c_int),
+        ("miss_id", ctypes.c_char * 32),
+        ("miss_time", ctypes.c_longlong),
+        ("simulated_until", ctypes.c_longlong),
+        ("bounded", ctypes.c_int),
+        ("segments", ctypes.c_longlong),
+        ("preemptions", ctypes.c_longlong),
+        ("aperiodic_served", ctypes.c_longlong),
+        ("aperiodic_pending", ctypes.c_longlong),
+        ("aperiodic_mean_response", ctypes.c_double),
+        ("aperiodic_p95_response", ctypes.c_longlong),
+        ("aperiodic_max_response", ctypes.c_longlong),
+        ("cycle_start", ctypes.c_longlong),
+        ("cycle_length", ctypes.c_longlong),
+    ]
+
+    def as_dict(self):
+        d = {name: getattr(self, name) for name, _ in self._fields_}
+        d["missed"] = bool(self.missed)
+        d["bounded"] = bool(self.bounded)
+        d["miss_id"] = self.miss_id.decode()
+        return d
+
+
+SEGMENT_FN = ctypes.CFUNCTYPE(None, ctypes.c_void_p, ctypes.c_longlong, ctypes.c_longlong,
+                              ctypes.c_char_p, ctypes.c_int)
+
+
+class RtsError(Exception):
+    pass
+
+
+def default_library_path():
+    name = "rts.dll" if sys.platform == "win32" else "librts.so"
+    return os.path.join(os.path.dirname(os.path.abspath(__file__)), name)
+
+
+class Library:
+    def __init__(self, path=None):
+        self.dll = ctypes.CDLL(path or default_library_path())
+        d = self.dll
+        d.rts_load.argtypes = [ctypes.c_char_p]
+        d.rts_load.restype = ctypes.c_void_p
+        d.rts_parse.argtypes = [ctypes.c_char_p]
+        d.rts_parse.restype = ctypes.c_void_p
+        d.rts_free.argtypes = [ctypes.c_void_p]
+        d.rts_free.restype = None
+        d.rts_set_count.argtypes = [ctypes.c_void_p]
+        d.rts_set_count.restype = ctypes.c_int
+        d.rts_set_name.argtypes = [ctypes.c_void_p, ctypes.c_int]
+        d.rts_set_name.restype = ctypes.c_char_p
+        d.rts_run.argtypes = [ctypes.c_void_p, ctypes.c_int, ctypes.c_char_p, ctypes.c_char_p,
+                              ctypes.c_longlong, ctypes.c_longlong, ctypes.c_char_p,
+                              SEGMENT_FN, ctypes.c_void_p, ctypes.POINTER(Result)]
+        d.rts_run.restype = ctypes.c_int
+        d.rts_error.argtypes = []
+        d.rts_error.restype = ctypes.c_char_p
+
+    def error(self):
+        return self.dll.rts_error().decode()
+
+    def load(self, path):
+        """Bir input dosyası veya dizinindeki task set'ler."""
+        handle = self.dll.rts_load(os.fsencode(path))
+        if not handle:
+            raise RtsError(self.error())
+        return TaskSets(self, handle)
+
+    def parse(self, text):
+        """Input dosyası içeriğinden (string) task set'ler."""
+        handle = self.dll.rts_parse(text.encode())
+        if not handle:
+            raise RtsError(self.error())
+        return TaskSets(self, handle)
+
+
+class TaskSets:
+    def __init__(self, lib, handle):
+        self.lib = lib
+        self.handle = handle
+
+    def close(self):
+        if self.handle:
+            self.lib.dll.rts_free(self.handle)
+            self.handle = None
+
+    def __del__(self):
+        self.close()
+
+    def __len__(self):
+        return self.lib.dll.rts_set_count(self.handle)
+
+    def name(self, index):
+        return self.lib.dll.rts_set_name(self.handle, index).decode()
+
+    def run(self, index, algorithm, server=None, budget=0, period=0, options="", on_segment=None):
+        """
+        index'teki task set'i simüle eder. on_segment verilirse her aralık için
+        on_segment(start, end, job, kind) çağrılır (kind: KIND_NAMES anahtarları) ve
+        aralık listesi None döner; verilmezse aralıklar (start, end, job, kind_adı) listesi döner.
+        options: komut satırı seçenekleri, ör. "--on-miss=continue --horizon=1000".
+        Dönüş: (sonuç dict'i, aralıklar)
+        """
+        intervals = None
+        if on_segment is None:
+            intervals = []
+
+            def on_segment(start, end, job, kind):
+                intervals.append((start, end, job, KIND_NAMES.get(kind, "idle")))
+
+        callback = SEGMENT_FN(lambda _, start, end, job, kind: on_segment(start, end, job.decode(), kind))
+        result = Result()
+        status = self.lib.dll.rts_run(self.handle, index, algorithm.encode(),
+                                      (server or "").encode(), int(budget or 0), int(period or 0),
+                                      options.encode(), callback, None, ctypes.byref(result))
+        if status != 0:
+            raise RtsError(self.lib.error())
+        return result.as_dict(), intervals
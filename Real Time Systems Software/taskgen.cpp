@@ -0,0 +1,153 @@
+#include <iostream>
+#include <vector>
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstdlib>
+#include <string>
+
+using namespace std;
+
+// Random task set generator for rts.exe. Utilisations are drawn with UUniFast (uniform over
+// the simplex of n values summing to U), periods log-uniformly in [Tmin,Tmax]. Output is a
+// multi-set file ("SET name" lines) that rts.exe --batch reads directly.
+//
+// taskgen SETS TASKS UTILISATION TMIN TMAX [options]
+//   --seed=S            random seed (default 1)
+//   --sweep=U1:STEP     generate SETS sets for every utilisation from UTILISATION to U1
+//   --hyperperiod=H     snap periods to divisors of H, keeps the simulated hyperperiod small
+//   --deadline=A        deadlines uniform in [C+A*(T-C), T], A=1 gives implicit deadlines
+//   --offsets           first releases uniform in [0,T)
+//   --aperiodic=N       N aperiodic tasks per set, released within two largest periods
+
+struct Options{
+    int sets=0;
+    int tasks=0;
+    double utilisation=0;
+    double lastUtilisation=-1;
+    double step=0.1;
+    int minPeriod=0;
+    int maxPeriod=0;
+    uint64_t seed=1;
+    int hyperperiod=0;
+    double deadline=1;
+    bool offsets=false;
+    int aperiodic=0;
+};
+
+// splitmix64, the same stream on every platform and standard library
+struct Random{
+    uint64_t state;
+    Random(uint64_t seed):state(seed){}
+    uint64_t next(){
+        uint64_t z=(state+=0x9E3779B97F4A7C15ULL);
+        z=(z^(z>>30))*0xBF58476D1CE4E5B9ULL;
+        z=(z^(z>>27))*0x94D049BB133111EBULL;
+        return z^(z>>31);
+    }
+    double uniform(){ return (next()>>11)*0x1.0p-53; }         // [0,1)
+    int between(int lo,int hi){ return lo+(int)(uniform()*(hi-lo+1)); } // [lo,hi]
+};
+
+vector<double> uunifast(Random& rng,int n,double u){
+    vector<double> out;
+    double sum=u;
+    for(int i=1;i<n;i++){
+        double next=sum*pow(rng.uniform(),1.0/(n-i));
+        out.push_back(sum-next);
+        sum=next;
+    }
+    out.push_back(sum);
+    return out;
+}
+
+int drawPeriod(Random& rng,const Options& o,const vector<int>& divisors){
+    double t=exp(log((double)o.minPeriod)+rng.uniform()*(log((double)o.maxPeriod+1)-log((double)o.minPeriod)));
+    int period=min(o.maxPeriod,max(o.minPeriod,(int)t));
+    if(divisors.empty())return period;
+    // largest divisor not above the draw, or the smallest one in range
+    auto it=upper_bound(divisors.begin(),divisors.end(),period);
+    if(it!=divisors.begin() && *(it-1)>=o.minPeriod)return *(it-1);
+    return *lower_bound(divisors.begin(),divisors.end(),o.minPeriod);
+}
+
+void generateSet(Random& rng,const Options& o,double u,const vector<int>& divisors){
+    vector<double> shares=uunifast(rng,o.tasks,u);
+    int longest=0;
+    for(double share:shares){
+        int t=drawPeriod(rng,o,divisors);
+        int c=max(1,(int)lround(share*t));
+        c=min(c,t);
+        int d=t;
+        if(o.deadline<1)d=min(t,c+(int)lround((o.deadline+rng.uniform()*(1-o.deadline))*(t-c)));
+        int r=o.offsets?(int)(rng.uniform()*t):0;
+        if(r==0 && d<t)cout<<"D "<<c<<" "<<t<<" "<<d<<"\n";
+        else if(d<t)cout<<"P "<<r<<" "<<c<<" "<<t<<" "<<d<<"\n";
+        else if(r>0)cout<<"P "<<r<<" "<<c<<" "<<t<<"\n";
+        else cout<<"P "<<c<<" "<<t<<"\n";
+        longest=max(longest,t);
+    }
+    for(int i=0;i<o.aperiodic;i++){
+        int release=(int)(rng.uniform()*2*longest);
+        int exec=rng.between(1,max(1,o.minPeriod/2));
+        cout<<"A "<<release<<" "<<exec<<"\n";
+    }
+}
+
+int main(int argc,char* argv[]){
+    Options o;
+    vector<string> args;
+    for(int i=1;i<argc;i++){
+        string a=argv[i];
+        if(a.rfind("--seed=",0)==0)o.seed=strtoull(a.c_str()+7,nullptr,10);
+        else if(a.rfind("--sweep=",0)==0){
+            o.lastUtilisation=atof(a.c_str()+8);
+            size_t colon=a.find(':');
+            if(colon!=string::npos)o.step=atof(a.c_str()+colon+1);
+        }
+        else if(a.rfind("--hyperperiod=",0)==0)o.hyperperiod=atoi(a.c_str()+14);
+        else if(a.rfind("--deadline=",0)==0)o.deadline=atof(a.c_str()+11);
+        else if(a=="--offsets")o.offsets=true;
+        else if(a.rfind("--aperiodic=",0)==0)o.aperiodic=atoi(a.c_str()+12);
+        else args.push_back(a);
+    }
+    if(args.size()!=5){
+        cerr<<"Usage: taskgen SETS TASKS UTILISATION TMIN TMAX [--seed=S] [--sweep=U1:STEP]"
+              " [--hyperperiod=H] [--deadline=A] [--offsets] [--aperiodic=N]"<<endl;
+        return 1;
+    }
+    o.sets=atoi(args[0].c_str());
+    o.tasks=atoi(args[1].c_str());
+    o.utilisation=atof(args[2].c_str());
+    o.minPeriod=atoi(args[3].c_str());
+    o.maxPeriod=atoi(args[4].c_str());
+    if(o.sets<1 || o.tasks<1 || o.utilisation<=0 || o.minPeriod<1 || o.maxPeriod<o.minPeriod
+       || o.deadline<0 || o.deadline>1 || o.step<=0){
+        cerr<<"Wrong arguments: need SETS>=1, TASKS>=1, UTILISATION>0, 1<=TMIN<=TMAX, 0<=deadline<=1"<<endl;
+        return 1;
+    }
+    if(o.lastUtilisation<0)o.lastUtilisation=o.utilisation;
+
+    vector<int> divisors;
+    if(o.hyperperiod>0){
+        for(int d=1;d<=o.hyperperiod;d++)
+            if(o.hyperperiod%d==0 && d>=o.minPeriod && d<=o.maxPeriod)divisors.push_back(d);
+        if(divisors.empty()){
+            cerr<<"No divisor of "<<o.hyperperiod<<" between "<<o.minPeriod<<" and "<<o.maxPeriod<<endl;
+            return 1;
+        }
+    }
+
+    Random rng(o.seed);
+    int level=0;
+    for(double u=o.utilisation;u<=o.lastUtilisation+1e-9;u=o.utilisation+(++level)*o.step){
+        for(int k=0;k<o.sets;k++){
+            cout<<"SET u"<<fixed;
+            cout.precision(2);
+            cout<<u<<"_"<<k<<"\n";
+            cout.unsetf(ios::fixed);
+            generateSet(rng,o,u,divisors);
+        }
+    }
+    return 0;
+}
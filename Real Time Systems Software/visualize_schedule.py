@@ -1,17 +1,25 @@
 import argparse
 import subprocess
 import re
+import csv
+import io
+import os
+import struct
+import tempfile
 from collections import defaultdict
 import itertools
 import matplotlib.pyplot as plt
 
+import rts
+from rts import default_library_path
+
 
 # ----------------- 1) C++ programını çalıştır ----------------- #
 
-def run_cpp(exe, input_file, algo, server=None, budget=None, period=None):
+def run_cpp(exe, input_file, algo, server=None, budget=None, period=None, extra=()):
     """
     C++ rts.exe'yi verilen parametrelerle çalıştırır,
-    stdout'u string olarak döndürür.
+    stdout'u string olarak döndürür. extra: --trace=... gibi ek seçenekler.
 
     Çağrı formatları:
       - exe input algo
@@ -32,6 +40,7 @@ def run_cpp(exe, input_file, algo, server=None, budget=None, period=None):
                     f"(ör: deferrable 1 3)."
                 )
             cmd.extend([server, str(budget), str(period)])
+    cmd.extend(extra)
 
     print("Running command:", " ".join(cmd))  # debug için
 
@@ -58,6 +67,7 @@ def parse_schedule(log_text: str):
       - System can run aperiodic task at time:10. + Aperiodic Task: A1 is running. (background)
       - 10 is IDLE
       - System is Idle at 23.
+      - At time: 4 Context switch to T1   (--switch-cost / --crpd)
     """
 
     # Periyodik task: "At time: 0 TaskT2 is running"
@@ -87,6 +97,12 @@ def parse_schedule(log_text: str):
         re.IGNORECASE
     )
 
+    # Context switch / cache reload: "At time: 4 Context switch to T1"
+    pattern_switch = re.compile(
+        r'At time:\s*(\d+)\s+Context switch to\s+(\S+)',
+        re.IGNORECASE
+    )
+
     # Eski idle: "10 is IDLE"
     pattern_idle_old = re.compile(
         r'(\d+)\s+is\s+IDLE',
@@ -114,6 +130,13 @@ def parse_schedule(log_text: str):
             pending_bg_time = None  # garanti olsun diye temizleyelim
             continue
 
+        # 1b) Context switch: o job'a geçiş süresi
+        m_sw = pattern_switch.search(line)
+        if m_sw:
+            schedule[int(m_sw.group(1))] = f"{m_sw.group(2)} (switch)"
+            pending_bg_time = None
+            continue
+
         # 2) Server / aperiodik job (deferrable / polling vs.)
         m2 = pattern_server.search(line)
         if m2:
@@ -196,6 +219,96 @@ def parse_schedule(log_text: str):
 
 
 
+# ----------------- 2b) Aralık (interval) trace'ini oku ----------------- #
+
+# rts --trace=csv/bin sadece çalışan job değiştiğinde bir aralık yazar,
+# satır satır regex yerine aralıklar doğrudan okunur.
+KIND_NAMES = {0: "idle", 1: "task", 2: "server", 3: "aperiodic", 4: "switch"}
+
+
+def interval_label(job, kind):
+    """Aralığı text parser'ın kullandığı etiketlere çevirir."""
+    if kind == "task":
+        return f"Task{job}"
+    if kind == "server":
+        return f"{job} (via server)"
+    if kind == "aperiodic":
+        return job
+    if kind == "switch":
+        return f"{job} (switch)"
+    return "IDLE"
+
+
+def group_intervals(rows):
+    """rows: (start, end, job, kind) -> ({label: [(start, duration)]}, max_time)"""
+    task_intervals = defaultdict(list)
+    max_time = None
+    for start, end, job, kind in rows:
+        task_intervals[interval_label(job, kind)].append((start, end - start))
+        max_time = end - 1 if max_time is None else max(max_time, end - 1)
+    if max_time is None:
+        raise ValueError("Trace içinde aralık bulunamadı.")
+    return task_intervals, max_time
+
+
+def parse_csv_trace(text: str):
+    """start,end,job,kind satırları (başlık satırından sonrası)."""
+    if "start,end,job,kind" not in text:
+        raise ValueError("CSV trace başlığı bulunamadı.")
+    body = text.split("start,end,job,kind", 1)[1]
+    rows = []
+    for r in csv.reader(io.StringIO(body)):
+        # program mesajları (deadline missed vs.) aralık değil
+        if len(r) != 4 or not r[0].isdigit():
+            continue
+        rows.append((int(r[0]), int(r[1]), r[2], r[3]))
+    return group_intervals(rows)
+
+
+def parse_binary_trace(data: bytes):
+    """
+    "RTSI", uint32 versiyon, uint32 isim sayısı, isimler (uint16 uzunluk + byte),
+    sonra 21 byte'lık kayıtlar: int64 start, int64 end, int32 isim indexi (-1 idle), uint8 kind
+    (versiyon 1: int32 start ve end, 13 byte'lık kayıtlar)
+    """
+    if data[:4] != b"RTSI":
+        raise ValueError("Binary trace değil.")
+    version, count = struct.unpack_from("<II", data, 4)
+    if version not in (1, 2):
+        raise ValueError(f"Bilinmeyen binary trace versiyonu: {version}")
+    offset = 12
+    names = []
+    for _ in range(count):
+        (length,) = struct.unpack_from("<H", data, offset)
+        names.append(data[offset + 2:offset + 2 + length].decode())
+        offset += 2 + length
+    rows = []
+    record = "<iiiB" if version == 1 else "<qqiB"
+    for start, end, index, kind in struct.iter_unpack(record, data[offset:]):
+        job = names[index] if index >= 0 else ""
+        rows.append((start, end, job, KIND_NAMES.get(kind, "idle")))
+    return group_intervals(rows)
+
+
+# ----------------- 2c) librts ile aynı process içinde çalıştır ----------------- #
+
+def run_library(lib_path, input_file, algo, server=None, budget=None, period=None):
+    """
+    rts.exe'yi başlatmadan librts ile simüle eder (rts.py), aralıkları doğrudan alır.
+    """
+    lib = rts.Library(lib_path)
+    sets = lib.load(input_file)
+    if server is not None and server.lower() != "background" and (budget is None or period is None):
+        raise ValueError(
+            f"Server='{server}' için budget ve period vermen gerekiyor "
+            f"(ör: deferrable 1 3)."
+        )
+    result, rows = sets.run(0, algo, server, budget or 0, period or 0)
+    if result["missed"]:
+        print(f"Deadline missed for {result['miss_id']} at {result['miss_time']}.")
+    return group_intervals(rows)
+
+
 # ----------------- 3) Timeline (Gantt) çiz ----------------- #
 
 def plot_timeline(task_intervals, max_time, title="Schedule Timeline"):
@@ -258,20 +371,50 @@ def main():
     parser.add_argument("server", nargs="?", default=None, help="Server adı (opsiyonel)")
     parser.add_argument("budget", nargs="?", default=None, help="Server budget (opsiyonel)")
     parser.add_argument("period", nargs="?", default=None, help="Server period (opsiyonel)")
+    # lib: librts ile process başlatmadan, bin/csv: programdan sadece aralıkları iste,
+    # text: eski satır satır çıktı. Varsayılan: kütüphane varsa lib, yoksa bin
+    parser.add_argument("--format", choices=["lib", "bin", "csv", "text"], default=None,
+                        help="Programdan alınacak çıktı formatı (varsayılan: lib, kütüphane yoksa bin)")
+    parser.add_argument("--lib", default=None,
+                        help="librts.so / rts.dll yolu (varsayılan: rts.py'nin yanındaki)")
 
     args = parser.parse_args()
 
     try:
-        log_text = run_cpp(
+        run = lambda extra=(): run_cpp(
             args.exe,
             args.input_file,
             args.algorithm,
             server=args.server,
             budget=args.budget,
-            period=args.period
+            period=args.period,
+            extra=extra
         )
 
-        task_intervals, max_time = parse_schedule(log_text)
+        fmt = args.format
+        if fmt is None:
+            # kütüphane derlenmemişse exe ile devam
+            lib_path = args.lib or default_library_path()
+            fmt = "lib" if os.path.exists(lib_path) else "bin"
+
+        if fmt == "lib":
+            task_intervals, max_time = run_library(
+                args.lib, args.input_file, args.algorithm,
+                server=args.server, budget=args.budget, period=args.period
+            )
+        elif fmt == "bin":
+            fd, path = tempfile.mkstemp(suffix=".rtsi")
+            os.close(fd)
+            try:
+                run(["--trace=bin", f"--out={path}"])
+                with open(path, "rb") as f:
+                    task_intervals, max_time = parse_binary_trace(f.read())
+            finally:
+                os.remove(path)
+        elif fmt == "csv":
+            task_intervals, max_time = parse_csv_trace(run(["--trace=csv"]))
+        else:
+            task_intervals, max_time = parse_schedule(run())
 
         title = f"{args.algorithm.upper()} Schedule Timeline"
         if args.server: